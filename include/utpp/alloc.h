@@ -0,0 +1,358 @@
+#pragma once
+/*
+  UTPP - A New Generation of UnitTest++
+  (c) Mircea Neacsu 2017-2025
+
+  See LICENSE file for full copyright information.
+*/
+
+/*!
+  \file alloc.h
+  \brief Heap allocation accounting
+
+  Allocation counting is optional. To enable it, define the symbol
+  `UTPP_TRACK_ALLOCATIONS` before including `utpp.h` in __one__ of the source
+  files of the test program:
+  ```
+  #define UTPP_TRACK_ALLOCATIONS
+  #include <utpp/utpp.h>
+  ```
+  That file will contain replacements for the global `operator new` and
+  `operator delete` functions that keep per-thread allocation counters.
+*/
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+namespace UnitTest {
+
+/// Allocation statistics for a test or a section of a test
+struct AllocStats
+{
+  size_t count;               ///< Number of allocations
+  size_t bytes;               ///< Total number of bytes allocated
+  size_t peak;                ///< Peak number of bytes in use
+  long long leaked;           ///< Bytes allocated and not released
+};
+
+/*!
+  Per-thread allocation counters maintained by the replacement `operator new`
+  and `operator delete` functions.
+
+  `live` and `peak` are signed because a thread can release memory allocated
+  by another thread.
+*/
+struct AllocCounters
+{
+  size_t count;               ///< Number of allocations
+  size_t bytes;               ///< Total number of bytes allocated
+  long long live;             ///< Number of bytes currently in use
+  long long peak;             ///< Maximum value of `live`
+  int paused;                 ///< If not 0, new allocations are not counted
+};
+
+#if UTPP_CPP_LANG < 201703L
+/// If `true`, tests that leak memory are reported as failed
+extern bool fail_on_leaks;
+#else
+/// If `true`, tests that leak memory are reported as failed
+inline bool fail_on_leaks = false;
+#endif
+
+/// Return allocation counters of current thread
+inline
+AllocCounters& alloc_counters ()
+{
+  static thread_local AllocCounters counters;
+  return counters;
+}
+
+/*!
+  Return a reference to the flag showing if the replacement allocation
+  functions are installed.
+
+  The flag is set by the source file that defines `UTPP_TRACK_ALLOCATIONS`.
+*/
+inline
+bool& alloc_tracking_installed ()
+{
+  static bool installed = false;
+  return installed;
+}
+
+/*!
+  Measures allocations made by current thread between the creation of the
+  object and a call to stats() function.
+
+  Meters can be nested.
+*/
+class AllocMeter
+{
+public:
+  AllocMeter ();
+  ~AllocMeter ();
+  AllocStats stats () const;
+
+private:
+  AllocMeter (const AllocMeter&) = delete;
+  AllocMeter& operator= (const AllocMeter&) = delete;
+
+  AllocCounters start;
+};
+
+/// Allocations are not counted while an object of this type is in scope
+struct AllocPause
+{
+  AllocPause () { alloc_counters ().paused++; }
+  ~AllocPause () { alloc_counters ().paused--; }
+};
+
+/*!
+  Take a snapshot of current allocation counters.
+
+  The peak is reset to the number of bytes currently in use so that stats()
+  function reports the peak reached while the meter is active.
+*/
+inline
+AllocMeter::AllocMeter ()
+  : start (alloc_counters ())
+{
+  alloc_counters ().peak = start.live;
+}
+
+/// Restore peak value that might have been reset by constructor
+inline
+AllocMeter::~AllocMeter ()
+{
+  auto& c = alloc_counters ();
+  if (c.peak < start.peak)
+    c.peak = start.peak;
+}
+
+/// Return allocations made since the meter was created
+inline
+AllocStats AllocMeter::stats () const
+{
+  auto& c = alloc_counters ();
+  AllocStats s;
+  s.count = c.count - start.count;
+  s.bytes = c.bytes - start.bytes;
+  s.peak = (size_t)(c.peak - start.live);
+  s.leaked = c.live - start.live;
+  return s;
+}
+
+} //namespace UnitTest
+
+//------------------ Replacement allocation functions -------------------------
+#if defined(UTPP_TRACK_ALLOCATIONS)
+
+namespace UnitTest {
+
+/*!
+  Header placed in front of each memory block. It keeps the block size and
+  remembers if the allocation has been counted.
+*/
+struct alloc_header
+{
+  size_t size;
+  size_t counted;
+};
+
+static_assert (sizeof (alloc_header) <= alignof (std::max_align_t),
+  "Allocation header would misalign memory blocks");
+
+/*!
+  Allocate a counted memory block.
+  \param size    Requested size
+  \param align   Block alignment
+  \return Pointer to allocated block
+
+  The allocation header occupies `align` bytes in front of the returned block.
+  If allocation fails, the function calls the new handler. If there is no new
+  handler, it throws `std::bad_alloc`.
+*/
+inline
+void* tracked_alloc (size_t size, size_t align = alignof (std::max_align_t))
+{
+  if (align < alignof (std::max_align_t))
+    align = alignof (std::max_align_t);
+  for (;;)
+  {
+    char* p;
+    if (align == alignof (std::max_align_t))
+      p = (char*)malloc (size + align);
+    else
+#ifdef _WIN32
+      p = (char*)_aligned_malloc (size + align, align);
+#else
+      p = (char*)aligned_alloc (align, (size + 2 * align - 1) / align * align);
+#endif
+    if (p)
+    {
+      auto h = (alloc_header*)(p + align) - 1;
+      auto& c = alloc_counters ();
+      h->size = size;
+      h->counted = !c.paused;
+      if (!c.paused)
+      {
+        c.count++;
+        c.bytes += size;
+        c.live += size;
+        if (c.live > c.peak)
+          c.peak = c.live;
+      }
+      return p + align;
+    }
+    auto handler = std::get_new_handler ();
+    if (!handler)
+      throw std::bad_alloc ();
+    handler ();
+  }
+}
+
+/// Non-throwing version of tracked_alloc(). Returns `nullptr` on failure.
+inline
+void* tracked_alloc (size_t size, size_t align, std::nothrow_t) noexcept
+{
+  try {
+    return tracked_alloc (size, align);
+  }
+  catch (...) {
+    return nullptr;
+  }
+}
+
+/// Release a block allocated by tracked_alloc()
+inline
+void tracked_free (void* ptr, size_t align = alignof (std::max_align_t)) noexcept
+{
+  if (!ptr)
+    return;
+  if (align < alignof (std::max_align_t))
+    align = alignof (std::max_align_t);
+  auto h = (alloc_header*)ptr - 1;
+  if (h->counted)
+    alloc_counters ().live -= h->size;
+  auto p = (char*)ptr - align;
+#ifdef _WIN32
+  if (align != alignof (std::max_align_t))
+  {
+    _aligned_free (p);
+    return;
+  }
+#endif
+  free (p);
+}
+
+namespace {
+/// Tells the rest of the program that allocations are counted
+const bool alloc_tracking_flag = (alloc_tracking_installed () = true);
+}
+
+} //namespace UnitTest
+
+void* operator new (std::size_t size)
+{
+  return UnitTest::tracked_alloc (size);
+}
+
+void* operator new[] (std::size_t size)
+{
+  return UnitTest::tracked_alloc (size);
+}
+
+void* operator new (std::size_t size, const std::nothrow_t&) noexcept
+{
+  return UnitTest::tracked_alloc (size, alignof (std::max_align_t), std::nothrow);
+}
+
+void* operator new[] (std::size_t size, const std::nothrow_t&) noexcept
+{
+  return UnitTest::tracked_alloc (size, alignof (std::max_align_t), std::nothrow);
+}
+
+void operator delete (void* ptr) noexcept
+{
+  UnitTest::tracked_free (ptr);
+}
+
+void operator delete[] (void* ptr) noexcept
+{
+  UnitTest::tracked_free (ptr);
+}
+
+void operator delete (void* ptr, const std::nothrow_t&) noexcept
+{
+  UnitTest::tracked_free (ptr);
+}
+
+void operator delete[] (void* ptr, const std::nothrow_t&) noexcept
+{
+  UnitTest::tracked_free (ptr);
+}
+
+void operator delete (void* ptr, std::size_t) noexcept
+{
+  UnitTest::tracked_free (ptr);
+}
+
+void operator delete[] (void* ptr, std::size_t) noexcept
+{
+  UnitTest::tracked_free (ptr);
+}
+
+#if defined(__cpp_aligned_new)
+void* operator new (std::size_t size, std::align_val_t al)
+{
+  return UnitTest::tracked_alloc (size, (size_t)al);
+}
+
+void* operator new[] (std::size_t size, std::align_val_t al)
+{
+  return UnitTest::tracked_alloc (size, (size_t)al);
+}
+
+void* operator new (std::size_t size, std::align_val_t al, const std::nothrow_t&) noexcept
+{
+  return UnitTest::tracked_alloc (size, (size_t)al, std::nothrow);
+}
+
+void* operator new[] (std::size_t size, std::align_val_t al, const std::nothrow_t&) noexcept
+{
+  return UnitTest::tracked_alloc (size, (size_t)al, std::nothrow);
+}
+
+void operator delete (void* ptr, std::align_val_t al) noexcept
+{
+  UnitTest::tracked_free (ptr, (size_t)al);
+}
+
+void operator delete[] (void* ptr, std::align_val_t al) noexcept
+{
+  UnitTest::tracked_free (ptr, (size_t)al);
+}
+
+void operator delete (void* ptr, std::align_val_t al, const std::nothrow_t&) noexcept
+{
+  UnitTest::tracked_free (ptr, (size_t)al);
+}
+
+void operator delete[] (void* ptr, std::align_val_t al, const std::nothrow_t&) noexcept
+{
+  UnitTest::tracked_free (ptr, (size_t)al);
+}
+
+void operator delete (void* ptr, std::size_t, std::align_val_t al) noexcept
+{
+  UnitTest::tracked_free (ptr, (size_t)al);
+}
+
+void operator delete[] (void* ptr, std::size_t, std::align_val_t al) noexcept
+{
+  UnitTest::tracked_free (ptr, (size_t)al);
+}
+#endif //__cpp_aligned_new
+
+#endif //UTPP_TRACK_ALLOCATIONS
@@ -0,0 +1,318 @@
+#pragma once
+/*
+  UTPP - A New Generation of UnitTest++
+  (c) Mircea Neacsu 2017-2025
+
+  See LICENSE file for full copyright information.
+*/
+
+/*!
+  \file baseline.h
+  \brief Comparison of benchmark results with a saved baseline
+
+  Results of all benchmarks can be saved in a baseline file and compared
+  with those of a later run:
+  ```
+  UnitTest::benchmark_baseline.Load ("bench_baseline.txt");
+  int ret = UnitTest::RunAllTests ();
+  UnitTest::benchmark_baseline.Save ("bench_new.txt");
+  ```
+  The times of all repetitions of a benchmark are compared with those in the
+  baseline file using the Mann-Whitney U test. A benchmark is considered
+  slower or faster only if the difference is statistically significant.
+  By default, a significant slowdown is reported as a failure of the
+  benchmark.
+
+  Benchmarks that declare the number of bytes or items processed are compared
+  by their throughput instead of their time. Bytes per second are used if
+  both are declared.
+
+  A baseline file is a text file with one line for each benchmark. The line
+  contains the benchmark name followed by the number of repetitions and the
+  time per iteration (in nanoseconds) of each repetition. For benchmarks
+  compared by throughput, the name is followed by `@bytes/s` or `@items/s`
+  and the values are the throughput of each repetition.
+*/
+
+#include <string>
+#include <vector>
+#include <map>
+#include <fstream>
+#include <algorithm>
+#include <cmath>
+
+namespace UnitTest {
+
+/// Maximum number of results of a benchmark accepted from a baseline file
+const size_t BASELINE_MAX_SAMPLES = 10000;
+
+/*!
+  Store and compare benchmark results.
+
+  Results of the current run are kept in memory until they are written with
+  Save(). Results loaded with Load() are used as reference.
+*/
+class BenchmarkBaseline
+{
+public:
+  BenchmarkBaseline ();
+
+  bool Load (const std::string& filename);
+  bool Save (const std::string& filename) const;
+  void Clear ();
+
+  void Compare (const std::string& key, BenchmarkStats& stats);
+
+  /// Return `true` if reference results have been loaded
+  bool loaded () const { return !reference.empty (); }
+
+  double alpha;             ///< Significance level of comparisons
+  bool fail_on_regression;  ///< If `true`, a slowdown is a benchmark failure
+
+private:
+  std::map<std::string, std::vector<double>> reference;
+  std::map<std::string, std::vector<double>> current;
+};
+
+#if UTPP_CPP_LANG < 201703L
+/// Baseline used by all benchmarks
+extern BenchmarkBaseline benchmark_baseline;
+#else
+/// Baseline used by all benchmarks
+inline BenchmarkBaseline benchmark_baseline;
+#endif
+
+/// Return the unit of a compared quantity
+inline
+const char* metric_unit (Metric m)
+{
+  switch (m)
+  {
+  case mBytesRate: return "bytes/s";
+  case mItemsRate: return "items/s";
+  default:         return "ns";
+  }
+}
+
+/// Return a description of a comparison verdict
+inline
+const char* verdict_name (Verdict v)
+{
+  switch (v)
+  {
+  case vSame:   return "same";
+  case vFaster: return "faster";
+  case vSlower: return "slower";
+  default:      return "no baseline";
+  }
+}
+
+/*!
+  Return two-sided p-value of Mann-Whitney U test for two samples.
+
+  The p-value is the probability of observing a difference at least as large
+  as the one between the two samples if both come from the same distribution.
+
+  For small samples without ties the exact distribution of U statistic is
+  used. Otherwise, the p-value is obtained from the normal approximation
+  with tie and continuity corrections.
+*/
+inline
+double mann_whitney_p (const std::vector<double>& a, const std::vector<double>& b)
+{
+  const size_t n1 = a.size (), n2 = b.size (), n = n1 + n2;
+  if (!n1 || !n2)
+    return 1.;
+
+  //rank pooled samples; ties get the mean of their ranks
+  std::vector<std::pair<double, bool>> pool;
+  pool.reserve (n);
+  for (auto v : a)
+    pool.emplace_back (v, true);
+  for (auto v : b)
+    pool.emplace_back (v, false);
+  std::sort (pool.begin (), pool.end ());
+
+  double r1 = 0, ties = 0;
+  for (size_t i = 0; i < n;)
+  {
+    size_t j = i + 1;
+    while (j < n && pool[j].first == pool[i].first)
+      ++j;
+    double rank = (i + j + 1) / 2.; //ranks are 1-based
+    for (size_t k = i; k < j; ++k)
+    {
+      if (pool[k].second)
+        r1 += rank;
+    }
+    double t = (double)(j - i);
+    ties += t * t * t - t;
+    i = j;
+  }
+
+  double u1 = r1 - n1 * (n1 + 1) / 2.;
+  double u = std::min (u1, n1 * n2 - u1);
+
+  if (ties == 0 && n1 <= 12 && n2 <= 12)
+  {
+    //cnt[i][j][k] = number of arrangements of i and j values with U = k
+    const size_t umax = n1 * n2;
+    std::vector<std::vector<std::vector<double>>> cnt (n1 + 1,
+      std::vector<std::vector<double>> (n2 + 1, std::vector<double> (umax + 1, 0.)));
+    for (size_t i = 0; i <= n1; ++i)
+    {
+      for (size_t j = 0; j <= n2; ++j)
+      {
+        if (i == 0 || j == 0)
+        {
+          cnt[i][j][0] = 1;
+          continue;
+        }
+        for (size_t k = 0; k <= i * j; ++k)
+          cnt[i][j][k] = (k >= j ? cnt[i - 1][j][k - j] : 0.) + cnt[i][j - 1][k];
+      }
+    }
+    double total = 0, tail = 0;
+    for (size_t k = 0; k <= umax; ++k)
+    {
+      total += cnt[n1][n2][k];
+      if (k <= u)
+        tail += cnt[n1][n2][k];
+    }
+    return std::min (1., 2 * tail / total);
+  }
+
+  double mu = n1 * n2 / 2.;
+  double sigma = sqrt (n1 * n2 / 12. * ((n + 1) - ties / (n * (n - 1.))));
+  if (sigma == 0)
+    return 1.;
+  double z = (mu - u - 0.5) / sigma;
+  return z > 0 ? std::min (1., erfc (z / sqrt (2.))) : 1.;
+}
+
+/// Constructor
+inline
+BenchmarkBaseline::BenchmarkBaseline ()
+  : alpha (0.05)
+  , fail_on_regression (true)
+{
+}
+
+/*!
+  Load reference results from a baseline file.
+  \param filename  Name of baseline file
+  \return `true` if file was read successfully
+
+  Missing files are not an error: the results of the current run can become
+  the baseline of the next one. If the file is malformed, or a benchmark has
+  more than #BASELINE_MAX_SAMPLES results, the function returns `false` and
+  no reference results are kept.
+*/
+inline
+bool BenchmarkBaseline::Load (const std::string& filename)
+{
+  std::ifstream in (filename);
+  if (!in)
+    return false;
+
+  reference.clear ();
+  std::string key;
+  size_t count;
+  bool ok = true;
+  while (ok && in >> key >> count)
+  {
+    ok = (count <= BASELINE_MAX_SAMPLES);
+    auto& samples = reference[key];
+    samples.clear ();
+    double v;
+    while (ok && samples.size () < count && in >> v)
+      samples.push_back (v);
+    ok = ok && samples.size () == count;
+  }
+  if (!ok || !in.eof ())
+  {
+    reference.clear ();
+    return false;
+  }
+  return true;
+}
+
+/*!
+  Save results of current run to a baseline file.
+  \param filename  Name of baseline file
+  \return `true` if file was written successfully
+*/
+inline
+bool BenchmarkBaseline::Save (const std::string& filename) const
+{
+  std::ofstream out (filename);
+  if (!out)
+    return false;
+
+  out.precision (10);
+  for (auto& r : current)
+  {
+    out << r.first << ' ' << r.second.size ();
+    for (auto s : r.second)
+      out << ' ' << s;
+    out << '\n';
+  }
+  return (bool)out.flush ();
+}
+
+/// Forget results of current run and reference results
+inline
+void BenchmarkBaseline::Clear ()
+{
+  reference.clear ();
+  current.clear ();
+}
+
+/*!
+  Record benchmark results and compare them with reference results.
+  \param key    Benchmark name
+  \param stats  Benchmark results. Comparison results are stored in the
+                `comparison` member.
+*/
+inline
+void BenchmarkBaseline::Compare (const std::string& key, BenchmarkStats& stats)
+{
+  auto median = [](std::vector<double> v) {
+    std::sort (v.begin (), v.end ());
+    size_t mid = v.size () / 2;
+    return v.size () % 2 ? v[mid] : (v[mid - 1] + v[mid]) / 2;
+  };
+
+  Metric metric = stats.bytes > 0 ? mBytesRate : stats.items > 0 ? mItemsRate : mTime;
+  std::string name = key;
+  std::vector<double> samples = stats.samples;
+  if (metric != mTime)
+  {
+    double per_iteration = (metric == mBytesRate) ? stats.bytes : stats.items;
+    for (auto& s : samples)
+      s = s > 0 ? per_iteration * 1e9 / s : 0.;
+    name += '@';
+    name += metric_unit (metric);
+  }
+  current[name] = samples;
+  stats.comparison = BenchmarkComparison{ vNoBaseline, 0., 0., 1., metric };
+
+  auto ref = reference.find (name);
+  if (ref == reference.end () || ref->second.empty () || samples.empty ())
+    return;
+
+  double base = median (ref->second);
+  double value = median (samples);
+  auto& cmp = stats.comparison;
+  cmp.baseline = base;
+  cmp.delta = base > 0 ? (value - base) / base : 0.;
+  cmp.p_value = mann_whitney_p (ref->second, samples);
+  if (cmp.p_value >= alpha)
+    cmp.verdict = vSame;
+  else if (metric == mTime)
+    cmp.verdict = value > base ? vSlower : vFaster;
+  else
+    cmp.verdict = value < base ? vSlower : vFaster;
+}
+
+} //namespace UnitTest
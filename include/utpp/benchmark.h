@@ -0,0 +1,1592 @@
+#pragma once
+/*
+  UTPP - A New Generation of UnitTest++
+  (c) Mircea Neacsu 2017-2025
+
+  See LICENSE file for full copyright information.
+*/
+
+/*!
+  \file benchmark.h
+  \brief Definition of BENCHMARK macros and UnitTest::Benchmark class
+
+  Benchmarks are registered and run like any other test. They can be placed
+  in the same suite with the tests that verify the same code:
+  ```
+  SUITE (parser)
+  {
+    TEST (parse_header)
+    {
+      CHECK (parse ("GET / HTTP/1.1"));
+    }
+
+    BENCHMARK (parse_speed)
+    {
+      for (auto _ : state)
+        parse ("GET / HTTP/1.1");
+    }
+  }
+  ```
+  The number of iterations is calibrated so that each repetition runs for at
+  least `UnitTest::benchmark_min_time`. The benchmark is then repeated
+  `UnitTest::benchmark_repetitions` times and the statistics of the time per
+  iteration are sent to the reporter.
+
+  Benchmarks defined with BENCHMARK_ARGS macro run for a range of arguments.
+  Their results can be fitted to a complexity class (O(1), O(log N), O(N),
+  O(N log N) or O(N^2)) and the benchmark fails if the fitted complexity is
+  worse than the declared one.
+
+  Results can also be compared with those of a previous run (see baseline.h).
+
+  Latency benchmarks (see UnitTest::BenchmarkArgs::Latency) also time each
+  operation, or small batch of operations, and record the times in a
+  histogram (see histogram.h). Percentiles of the distribution are reported
+  and can be checked with CHECK_LATENCY macros.
+
+  Benchmarks that call UnitTest::BenchmarkState::SetBytesProcessed or
+  UnitTest::BenchmarkState::SetItemsProcessed also report their throughput.
+  For these benchmarks, the throughput is the quantity compared with the
+  baseline.
+
+  Multithreaded benchmarks (see UnitTest::BenchmarkArgs::Threads) run the
+  benchmark body on several threads at once, for each thread count in a list.
+  All threads start their measurement loop together and each one measures its
+  own time. Reporters show aggregate and per-thread iteration rates and the
+  scaling efficiency.
+
+  To reduce noise, benchmarks can be pinned to a CPU (`UnitTest::benchmark_cpu`),
+  run with a higher priority (`UnitTest::benchmark_high_priority`) and warmed
+  up before measurements (`UnitTest::benchmark_warmup`).
+*/
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <atomic>
+#include <memory>
+#include <cstring>
+#include <thread>
+#include <exception>
+#include <initializer_list>
+
+/// Marks a type whose variables can be unused without compiler warnings
+#if defined(__GNUC__) || defined(__clang__)
+#define UTPP_UNUSED_TYPE __attribute__ ((unused))
+#else
+#define UTPP_UNUSED_TYPE
+#endif
+
+/*!
+  \ingroup bench
+@{
+*/
+
+#ifdef BENCHMARK
+#error Macro BENCHMARK is already defined
+#endif
+
+#ifdef BENCHMARK_FIXTURE
+#error Macro BENCHMARK_FIXTURE is already defined
+#endif
+
+#ifdef BENCHMARK_ARGS
+#error Macro BENCHMARK_ARGS is already defined
+#endif
+
+#ifdef BENCHMARK_FIXTURE_ARGS
+#error Macro BENCHMARK_FIXTURE_ARGS is already defined
+#endif
+
+#ifdef CHECK_LATENCY
+#error Macro CHECK_LATENCY is already defined
+#endif
+
+#ifdef CHECK_LATENCY_P99
+#error Macro CHECK_LATENCY_P99 is already defined
+#endif
+
+/*!
+  \brief Defines a benchmark
+  This macro must be followed by a code block containing the benchmark. The
+  code block receives a UnitTest::BenchmarkState object called `state`. The
+  measured code must be placed in a loop over the `state` object:
+  ```
+  for (auto _ : state)
+  {
+    //code to measure
+  }
+  ```
+  Use UnitTest::DoNotOptimize() for results of the measured code so that the
+  compiler doesn't remove it.
+
+  \hideinitializer
+*/
+#define BENCHMARK(Name)                                                       \
+  class Bench##Name : public UnitTest::Benchmark                              \
+  {                                                                           \
+  public:                                                                     \
+    Bench##Name() : Benchmark(#Name, __FILE__, __LINE__) {}                   \
+  private:                                                                    \
+    void RunBenchmark (UnitTest::BenchmarkState& state) override;             \
+  };                                                                          \
+  UnitTest::Test* Name##_maker() {return new Bench##Name; }                   \
+  UnitTest::TestSuite::Inserter Name##_inserter (GetSuiteName(), #Name,       \
+    __FILE__, __LINE__, Name##_maker);                                        \
+  void Bench##Name::RunBenchmark (UnitTest::BenchmarkState& state)
+
+/*!
+  \brief  Defines a benchmark with an associated fixture
+
+  The fixture is initialized before calibration and teared down after the
+  last repetition.
+
+  \hideinitializer
+*/
+#define BENCHMARK_FIXTURE(Fixture, Name)                                      \
+  class Fixture##Name##Bench : public Fixture, public UnitTest::Benchmark     \
+  {                                                                           \
+  public:                                                                     \
+    Fixture##Name##Bench()                                                    \
+      : Fixture (), Benchmark(#Name, __FILE__, __LINE__) {}                   \
+  private:                                                                    \
+    void RunBenchmark (UnitTest::BenchmarkState& state) override;             \
+  };                                                                          \
+  UnitTest::Test* Name##_maker() {return new Fixture##Name##Bench;}           \
+  UnitTest::TestSuite::Inserter Name##_inserter (GetSuiteName(), #Name,       \
+    __FILE__, __LINE__, Name##_maker);                                        \
+  void Fixture##Name##Bench::RunBenchmark (UnitTest::BenchmarkState& state)
+
+/*!
+  \brief Defines a benchmark that runs for a set of arguments
+
+  The second macro argument is a chain of UnitTest::BenchmarkArgs member
+  function calls (without the leading dot) that define the arguments:
+  ```
+  BENCHMARK_ARGS (lookup, Range (8, 8192).Complexity (UnitTest::oLogN))
+  {
+    index idx (state.range ());
+    for (auto _ : state)
+      UnitTest::DoNotOptimize (idx.find (42));
+  }
+  ```
+  The benchmark is calibrated and run separately for each set of arguments.
+  Inside the benchmark, arguments are available through
+  UnitTest::BenchmarkState::range() function.
+
+  \hideinitializer
+*/
+#define BENCHMARK_ARGS(Name, ...)                                             \
+  class Bench##Name : public UnitTest::Benchmark                              \
+  {                                                                           \
+  public:                                                                     \
+    Bench##Name() : Benchmark(#Name, __FILE__, __LINE__,                      \
+      UnitTest::BenchmarkArgs ().__VA_ARGS__) {}                              \
+  private:                                                                    \
+    void RunBenchmark (UnitTest::BenchmarkState& state) override;             \
+  };                                                                          \
+  UnitTest::Test* Name##_maker() {return new Bench##Name; }                   \
+  UnitTest::TestSuite::Inserter Name##_inserter (GetSuiteName(), #Name,       \
+    __FILE__, __LINE__, Name##_maker);                                        \
+  void Bench##Name::RunBenchmark (UnitTest::BenchmarkState& state)
+
+/*!
+  \brief Defines a benchmark with an associated fixture that runs for a set
+  of arguments
+
+  See #BENCHMARK_ARGS for a description of arguments.
+
+  \hideinitializer
+*/
+#define BENCHMARK_FIXTURE_ARGS(Fixture, Name, ...)                            \
+  class Fixture##Name##Bench : public Fixture, public UnitTest::Benchmark     \
+  {                                                                           \
+  public:                                                                     \
+    Fixture##Name##Bench() : Fixture (), Benchmark(#Name, __FILE__, __LINE__, \
+      UnitTest::BenchmarkArgs ().__VA_ARGS__) {}                              \
+  private:                                                                    \
+    void RunBenchmark (UnitTest::BenchmarkState& state) override;             \
+  };                                                                          \
+  UnitTest::Test* Name##_maker() {return new Fixture##Name##Bench;}           \
+  UnitTest::TestSuite::Inserter Name##_inserter (GetSuiteName(), #Name,       \
+    __FILE__, __LINE__, Name##_maker);                                        \
+  void Fixture##Name##Bench::RunBenchmark (UnitTest::BenchmarkState& state)
+
+/*!
+  \brief Generate a benchmark failure if a latency percentile is not below a limit
+
+  The macro can be used only in latency benchmarks, after the measurement loop:
+  ```
+  BENCHMARK_ARGS (queue_push, Latency ())
+  {
+    for (auto _ : state)
+      q.push (1);
+    CHECK_LATENCY (99.9, std::chrono::microseconds (10));
+  }
+  ```
+  The limit is checked after all repetitions of the benchmark have finished.
+
+  \hideinitializer
+*/
+#define CHECK_LATENCY(percentile, below)                                      \
+  state.ExpectLatency ((percentile),                                          \
+    std::chrono::duration_cast<std::chrono::nanoseconds>(below),              \
+    __FILE__, __LINE__)
+
+/*!
+  \brief Generate a benchmark failure if the 99th latency percentile is not
+  below a limit
+
+  \hideinitializer
+*/
+#define CHECK_LATENCY_P99(below) CHECK_LATENCY (99., below)
+
+///@}
+
+namespace UnitTest {
+
+#if UTPP_CPP_LANG < 201703L
+/// Minimum run time of each benchmark repetition
+extern std::chrono::milliseconds benchmark_min_time;
+
+/// Number of repetitions of each benchmark
+extern int benchmark_repetitions;
+
+/// Time spent running each benchmark before measurements
+extern std::chrono::milliseconds benchmark_warmup;
+
+/// CPU benchmarks are pinned to or -1 to let the system choose
+extern int benchmark_cpu;
+
+/// If `true`, benchmarks run with raised scheduling priority
+extern bool benchmark_high_priority;
+#else
+/// Minimum run time of each benchmark repetition
+inline std::chrono::milliseconds benchmark_min_time{ 100 };
+
+/// Number of repetitions of each benchmark
+inline int benchmark_repetitions = 5;
+
+/// Time spent running each benchmark before measurements
+inline std::chrono::milliseconds benchmark_warmup{ 0 };
+
+/// CPU benchmarks are pinned to or -1 to let the system choose
+inline int benchmark_cpu = -1;
+
+/// If `true`, benchmarks run with raised scheduling priority
+inline bool benchmark_high_priority = false;
+#endif
+
+/*!
+  Return the environment in which benchmarks run.
+
+  The environment is captured when the function is first called, before the
+  first benchmark runs.
+*/
+inline
+const BenchmarkEnvironment& benchmark_environment ()
+{
+  static const BenchmarkEnvironment env = [] {
+    auto e = capture_environment (benchmark_cpu >= 0 ? benchmark_cpu : 0);
+    e.pinned_cpu = benchmark_cpu;
+    return e;
+  }();
+  return env;
+}
+
+//------------------ Optimizer barriers --------------------------------------
+
+/*!
+  \fn void DoNotOptimize (const T& value)
+  \brief Forces the compiler to compute a value.
+
+  The compiler assumes that the value is read by some code it cannot see, so
+  the computation that produces it cannot be removed or hoisted out of a loop:
+  ```
+  for (auto _ : state)
+    UnitTest::DoNotOptimize (compute (x));
+  ```
+  If the argument is a non-const variable, the compiler also assumes it might
+  have been modified. The function doesn't generate any instructions, other
+  than those needed to store the value in memory.
+*/
+
+/*!
+  \fn void ClobberMemory ()
+  \brief Forces the compiler to complete all pending memory writes.
+
+  The compiler assumes that all memory can be read and written by code it
+  cannot see. Writes made before the call cannot be removed and values cannot
+  be kept in registers across the call.
+*/
+
+#if defined(__GNUC__) || defined(__clang__)
+template <typename T>
+inline
+void DoNotOptimize (const T& value)
+{
+  asm volatile ("" : : "m" (value) : "memory");
+}
+
+template <typename T>
+inline
+void DoNotOptimize (T& value)
+{
+  asm volatile ("" : "+m" (value) : : "memory");
+}
+
+inline
+void ClobberMemory ()
+{
+  asm volatile ("" : : : "memory");
+}
+#else
+/// Makes the address of an object visible to the outside world
+inline
+void escape_pointer (const volatile char* ptr)
+{
+  static const volatile char* volatile sink;
+  sink = ptr;
+}
+
+template <typename T>
+inline
+void DoNotOptimize (const T& value)
+{
+  escape_pointer (&reinterpret_cast<const volatile char&>(value));
+  std::atomic_signal_fence (std::memory_order_acq_rel);
+}
+
+inline
+void ClobberMemory ()
+{
+  std::atomic_signal_fence (std::memory_order_acq_rel);
+}
+#endif
+
+/// Maximum number of iterations in a benchmark repetition
+const size_t BENCHMARK_MAX_ITERATIONS = 1000000000;
+
+/*!
+  Barrier that releases a group of threads together.
+
+  Waiting threads spin instead of blocking so that they are released with
+  minimum delay. If there are more threads than processors, they yield after
+  spinning for a while.
+*/
+class SpinBarrier
+{
+public:
+  explicit SpinBarrier (int count);
+  void Wait ();
+
+private:
+  const int count;
+  std::atomic<int> waiting;
+  std::atomic<unsigned> generation;
+};
+
+/// Upper limit of a latency percentile set by CHECK_LATENCY macros
+struct LatencyLimit
+{
+  double percentile;                ///< Checked percentile
+  std::chrono::nanoseconds limit;   ///< Percentile must be below this value
+  const char* file;                 ///< Filename of check
+  int line;                         ///< Line number of check
+};
+
+/*!
+  Arguments of a parameterized benchmark.
+
+  Member functions return a reference to the object so that calls can be
+  chained:
+  ```
+  UnitTest::BenchmarkArgs ().Range (8, 512).DenseRange (1, 4).Complexity ()
+  ```
+  Each call to Range() or DenseRange() adds a dimension and the benchmark is
+  run for every combination of values (the cartesian product of all
+  dimensions). Arg() and Args() add individual argument sets that are run
+  before those generated by ranges.
+*/
+class BenchmarkArgs
+{
+public:
+  BenchmarkArgs ();
+
+  BenchmarkArgs& Arg (long long value);
+  BenchmarkArgs& Args (std::initializer_list<long long> values);
+  BenchmarkArgs& Range (long long lo, long long hi, long long mult = 8);
+  BenchmarkArgs& DenseRange (long long lo, long long hi, long long step = 1);
+  BenchmarkArgs& Complexity (BigO big_o = oAuto);
+  BenchmarkArgs& Latency (size_t batch = 1);
+  BenchmarkArgs& Threads (std::initializer_list<int> counts);
+  BenchmarkArgs& ThreadRange (int lo, int hi);
+
+  std::vector<std::vector<long long>> points () const;
+
+  /// Return declared complexity
+  BigO complexity () const { return expected; }
+
+  /// Return number of iterations timed together or 0 if latency is not measured
+  size_t latency_batch () const { return batch; }
+
+  /// Return thread counts or an empty vector if benchmark is not multithreaded
+  const std::vector<int>& threads () const { return thread_counts; }
+
+private:
+  std::vector<std::vector<long long>> sets;
+  std::vector<std::vector<long long>> dimensions;
+  BigO expected;
+  size_t batch;
+  std::vector<int> thread_counts;
+};
+
+/*!
+  Controls the measurement loop of a benchmark.
+
+  The object runs a predetermined number of iterations and measures the time
+  spent in the loop. It can be used in a range-based for loop:
+  ```
+  for (auto _ : state)
+    ...
+  ```
+  or, for older compilers, in a while loop:
+  ```
+  while (state.KeepRunning ())
+    ...
+  ```
+*/
+class BenchmarkState
+{
+public:
+  /// Value returned by iterators. It is never used.
+  struct UTPP_UNUSED_TYPE Value {};
+  class iterator;
+
+  BenchmarkState (size_t iterations, const std::vector<long long>& args);
+
+  iterator begin ();
+  iterator end ();
+  bool KeepRunning ();
+
+  void PauseTiming ();
+  void ResumeTiming ();
+
+  /// Return number of iterations to run
+  size_t iterations () const { return max_iterations; }
+
+  /// Return time spent in the measurement loop
+  std::chrono::nanoseconds elapsed () const { return total; }
+
+  long long range (size_t i = 0) const;
+
+  /// Return all arguments of the benchmark
+  const std::vector<long long>& args () const { return arguments; }
+
+  /// Set problem size used for complexity fitting. Default is `range(0)`.
+  void SetComplexityN (long long n) { complexity_n = n; }
+
+  /// Return problem size used for complexity fitting
+  long long complexity () const { return complexity_n; }
+
+  /// Return performance counters of the measurement loop (see perf.h)
+  const PerfCounters& perf_counters () const { return perf_total; }
+
+  /// Return histogram of latencies or `nullptr` if latency is not measured
+  const LatencyHistogram* latency () const { return histogram; }
+
+  void ExpectLatency (double percentile, std::chrono::nanoseconds limit,
+    const char* file, int line);
+
+  /// Return index of thread running this loop (0 to `threads () - 1`)
+  int thread_index () const { return thread; }
+
+  /// Return number of threads running the benchmark
+  int threads () const { return nthreads; }
+
+  /// Set number of bytes processed by all iterations of the loop
+  void SetBytesProcessed (long long bytes) { bytes_processed = bytes; }
+
+  /// Return number of bytes processed
+  long long bytes () const { return bytes_processed; }
+
+  /// Set number of items processed by all iterations of the loop
+  void SetItemsProcessed (long long items) { items_processed = items; }
+
+  /// Return number of items processed
+  long long items () const { return items_processed; }
+
+private:
+  friend class Benchmark;
+  BenchmarkState (const BenchmarkState&) = delete;
+  BenchmarkState& operator= (const BenchmarkState&) = delete;
+
+  void Start ();
+  void Finish ();
+  std::chrono::nanoseconds Elapsed () const;
+  bool Lap (size_t count, size_t& next);
+  size_t NextLap (size_t count) const;
+
+  size_t max_iterations;
+  size_t remaining;
+  const std::vector<long long>& arguments;
+  long long complexity_n;
+  bool started;
+  bool paused;
+  Timer timer;
+  std::chrono::nanoseconds total;
+  bool perf;
+  PerfCounters perf_start;
+  PerfCounters perf_total;
+
+  LatencyHistogram* histogram;
+  std::vector<LatencyLimit>* limits;
+  size_t batch;
+  size_t stop;            ///< iteration count of next lap
+  size_t lap_count;       ///< iteration count at start of current lap
+  long long lap_start;    ///< start time of current lap
+  long long lap_time;     ///< time accumulated in current lap before a pause
+
+  int thread;
+  int nthreads;
+  SpinBarrier* barrier;
+
+  long long bytes_processed;
+  long long items_processed;
+};
+
+/// Iterator over the iterations of a benchmark
+class BenchmarkState::iterator
+{
+public:
+  iterator () : count (0), stop (0), state (nullptr) {}
+  explicit iterator (BenchmarkState* st)
+    : count (st->max_iterations), stop (st->stop), state (st) {}
+
+  Value operator* () const { return Value (); }
+  iterator& operator++ () { --count; return *this; }
+
+  /*!
+    Stops the timer when all iterations have been done. In latency
+    benchmarks, also records the time of each batch of iterations.
+  */
+  bool operator!= (const iterator&)
+  {
+    if (count != stop)
+      return true;
+    return state->Lap (count, stop);
+  }
+
+private:
+  size_t count;
+  size_t stop;
+  BenchmarkState* state;
+};
+
+/// A test that measures the running time of a piece of code
+class Benchmark : public Test
+{
+public:
+  Benchmark (const Symbol& name, const char* file, int line,
+    const BenchmarkArgs& args = BenchmarkArgs ());
+  const std::vector<BenchmarkStats>& benchmark_results () const;
+
+protected:
+  /// Actual body of benchmark
+  virtual void RunBenchmark (BenchmarkState& state) = 0;
+
+private:
+  void RunImpl () override;
+  bool RunArgs (const std::vector<long long>& args, std::vector<double>& times,
+    BenchmarkStats& stats);
+  std::chrono::nanoseconds Measure (size_t iterations,
+    const std::vector<long long>& args, BenchmarkStats& stats);
+  std::chrono::nanoseconds MeasureThreads (size_t iterations,
+    const std::vector<long long>& args, BenchmarkStats& stats);
+  void CheckComplexity ();
+  void CheckLatency ();
+
+  const char* filename;
+  int line_number;
+  BenchmarkArgs arguments;
+  std::vector<BenchmarkStats> results;
+  std::unique_ptr<LatencyHistogram> latency;
+  std::vector<LatencyLimit> latency_limits;
+  int nthreads;
+  bool loop_started;        ///< `true` if last run entered the measurement loop
+};
+
+/*!
+  Output benchmark throughput.
+
+  Rates are shown with decimal prefixes (k, M, G, T). Only rates that have
+  been set are shown.
+*/
+inline
+void write_throughput (std::ostream& os, const BenchmarkStats& stats)
+{
+  static const char* prefix[] = { "", "k", "M", "G", "T" };
+  auto scale = [](double& r) {
+    int i = 0;
+    for (; r >= 1000. && i < 4; ++i)
+      r /= 1000.;
+    return prefix[i];
+  };
+  double r;
+  if (stats.bytes_rate > 0)
+  {
+    r = stats.bytes_rate;
+    auto p = scale (r);
+    os << r << ' ' << p << "B/s";
+  }
+  if (stats.bytes_rate > 0 && stats.items_rate > 0)
+    os << ", ";
+  if (stats.items_rate > 0)
+  {
+    r = stats.items_rate;
+    auto p = scale (r);
+    os << r << p << " items/s";
+  }
+}
+
+/// Return the usual notation of a complexity class
+inline
+const char* big_o_name (BigO big_o)
+{
+  switch (big_o)
+  {
+  case o1:        return "O(1)";
+  case oLogN:     return "O(log N)";
+  case oN:        return "O(N)";
+  case oNLogN:    return "O(N log N)";
+  case oNSquared: return "O(N^2)";
+  default:        return "?";
+  }
+}
+
+/*!
+  Output benchmark results.
+
+  Results follow the benchmark name: arguments, number of threads and time
+  per iteration on the first line, then, on separate lines, throughput, thread
+  scaling, comparison with the baseline, performance counters and latency.
+  Numbers are shown with two decimals.
+*/
+inline
+void write_benchmark (std::ostream& os, const BenchmarkStats& stats)
+{
+  auto f = os.flags (std::ios::dec | std::ios::fixed);
+  auto p = os.precision (2);
+  for (auto a : stats.args)
+    os << '/' << a;
+  if (stats.threads)
+    os << "/threads:" << stats.threads;
+  os << ": " << stats.mean << " ns/iteration (median "
+    << stats.median << " ns, stddev " << stats.stddev << " ns, min " << stats.min
+    << " ns; " << stats.repetitions << " x " << stats.iterations << " iterations)"
+    << '\n';
+  if (stats.bytes_rate > 0 || stats.items_rate > 0)
+  {
+    os << "  throughput: ";
+    write_throughput (os, stats);
+    os << '\n';
+  }
+  if (stats.threads)
+  {
+    os << "  threads " << stats.threads << ": " << stats.total_rate / 1e6
+      << "M iterations/s total, " << stats.thread_rate / 1e6
+      << "M iterations/s per thread, efficiency " << stats.efficiency * 100 << '%'
+      << '\n';
+  }
+  auto& cmp = stats.comparison;
+  if (cmp.verdict != vNoBaseline)
+  {
+    os << "  vs. baseline " << cmp.baseline << ' ' << metric_unit (cmp.metric)
+      << ": " << std::showpos
+      << cmp.delta * 100 << std::noshowpos << "% (confidence "
+      << (1 - cmp.p_value) * 100 << "%) - " << verdict_name (cmp.verdict)
+      << '\n';
+  }
+  if (perf_tracking ())
+  {
+    os << "  counters: ";
+    write_perf_counters (os, stats.perf, (double)stats.iterations * stats.repetitions);
+    os << '\n';
+  }
+  if (stats.latency.samples)
+  {
+    os << "  latency: ";
+    write_latency (os, stats.latency);
+    os << '\n';
+  }
+  os.flags (f);
+  os.precision (p);
+}
+
+/// Output the complexity class of a parameterized benchmark and the fit error
+inline
+void write_complexity (std::ostream& os, const ComplexityFit& fit)
+{
+  auto f = os.flags (std::ios::dec | std::ios::fixed);
+  auto p = os.precision (2);
+  os << big_o_name (fit.big_o) << " (coefficient " << fit.coefficient
+    << " ns, RMS error " << fit.rms * 100 << "%)";
+  os.flags (f);
+  os.precision (p);
+}
+
+/*!
+  Find the complexity class that best fits benchmark results.
+
+  For each class, the time per iteration is fitted by least squares to
+  `coefficient * f(N)` where N is the `complexity_n` value of each result.
+  The class with the smallest RMS error is selected. The error is normalized
+  by the mean time per iteration.
+
+  Median times are used as they are less sensitive to outliers.
+*/
+inline
+ComplexityFit fit_complexity (const std::vector<BenchmarkStats>& results)
+{
+  ComplexityFit best{ oNone, 0., 0. };
+  if (results.empty ())
+    return best;
+
+  double mean = 0;
+  for (auto& r : results)
+    mean += r.median;
+  mean /= results.size ();
+
+  for (int c = o1; c <= oNSquared; ++c)
+  {
+    auto f = [c](double n) -> double {
+      switch (c)
+      {
+      case oLogN:     return n > 1 ? log2 (n) : 0.;
+      case oN:        return n;
+      case oNLogN:    return n > 1 ? n * log2 (n) : 0.;
+      case oNSquared: return n * n;
+      default:        return 1.;
+      }
+    };
+    double sum_tf = 0, sum_ff = 0;
+    for (auto& r : results)
+    {
+      double fn = f ((double)r.complexity_n);
+      sum_tf += r.median * fn;
+      sum_ff += fn * fn;
+    }
+    double coef = sum_ff > 0 ? sum_tf / sum_ff : 0.;
+    double err = 0;
+    for (auto& r : results)
+    {
+      double d = r.median - coef * f ((double)r.complexity_n);
+      err += d * d;
+    }
+    double rms = mean > 0 ? sqrt (err / results.size ()) / mean : 0.;
+    if (best.big_o == oNone || rms < best.rms)
+      best = ComplexityFit{ (BigO)c, coef, rms };
+  }
+  return best;
+}
+
+//------------------ SpinBarrier member functions -----------------------------
+
+/// Constructor. \p count is the number of threads that must arrive at barrier.
+inline
+SpinBarrier::SpinBarrier (int count)
+  : count (count)
+  , waiting (0)
+  , generation (0)
+{
+}
+
+/// Wait until all threads have arrived at the barrier
+inline
+void SpinBarrier::Wait ()
+{
+  unsigned gen = generation.load (std::memory_order_acquire);
+  if (waiting.fetch_add (1, std::memory_order_acq_rel) + 1 == count)
+  {
+    waiting.store (0, std::memory_order_relaxed);
+    generation.fetch_add (1, std::memory_order_release);
+    return;
+  }
+  for (int spins = 0; generation.load (std::memory_order_acquire) == gen; ++spins)
+  {
+    if (spins >= 1000)
+      std::this_thread::yield ();
+  }
+}
+
+//------------------ BenchmarkArgs member functions ---------------------------
+
+/// Constructor. A benchmark without arguments runs only once.
+inline
+BenchmarkArgs::BenchmarkArgs ()
+  : expected (oNone)
+  , batch (0)
+{
+}
+
+/// Add a set with only one argument
+inline
+BenchmarkArgs& BenchmarkArgs::Arg (long long value)
+{
+  sets.push_back (std::vector<long long>{ value });
+  return *this;
+}
+
+/// Add a set of arguments
+inline
+BenchmarkArgs& BenchmarkArgs::Args (std::initializer_list<long long> values)
+{
+  sets.push_back (std::vector<long long> (values));
+  return *this;
+}
+
+/*!
+  Add a dimension with values in geometric progression.
+
+  The dimension contains `lo`, all powers of `mult` between `lo` and `hi`,
+  and `hi`.
+*/
+inline
+BenchmarkArgs& BenchmarkArgs::Range (long long lo, long long hi, long long mult)
+{
+  std::vector<long long> dim{ lo };
+  if (mult > 1)
+  {
+    long long v = 1;
+    while (v <= lo)
+      v *= mult;
+    for (; v < hi; v *= mult)
+      dim.push_back (v);
+  }
+  if (hi > lo)
+    dim.push_back (hi);
+  dimensions.push_back (dim);
+  return *this;
+}
+
+/// Add a dimension with values in arithmetic progression between `lo` and `hi`
+inline
+BenchmarkArgs& BenchmarkArgs::DenseRange (long long lo, long long hi, long long step)
+{
+  std::vector<long long> dim;
+  for (long long v = lo; v <= hi; v += (step > 0 ? step : 1))
+    dim.push_back (v);
+  dimensions.push_back (dim);
+  return *this;
+}
+
+/*!
+  Request complexity fitting of benchmark results.
+
+  \param big_o   Expected complexity class
+
+  If \p big_o is `oAuto`, the best fitting complexity class is reported.
+  Otherwise, the benchmark fails if the best fit is worse than \p big_o.
+*/
+inline
+BenchmarkArgs& BenchmarkArgs::Complexity (BigO big_o)
+{
+  expected = big_o;
+  return *this;
+}
+
+/*!
+  Request measurement of latency distribution.
+
+  \param batch   Number of iterations timed together
+
+  Each batch of iterations is timed separately and the time per iteration is
+  recorded in a histogram. Reading the time adds some overhead to each batch;
+  for very short operations, increase the batch size.
+*/
+inline
+BenchmarkArgs& BenchmarkArgs::Latency (size_t batch)
+{
+  this->batch = batch > 0 ? batch : 1;
+  return *this;
+}
+
+/*!
+  Run benchmark on several threads.
+
+  \param counts  Number of threads for each run
+
+  The benchmark runs separately for each thread count. Scaling efficiency is
+  computed relative to the first count, usually 1.
+
+  CHECK macros can be used by any thread. Failures of other threads are
+  reported by thread 0 after all threads have finished.
+*/
+inline
+BenchmarkArgs& BenchmarkArgs::Threads (std::initializer_list<int> counts)
+{
+  for (auto c : counts)
+    thread_counts.push_back (c > 0 ? c : 1);
+  return *this;
+}
+
+/// Run benchmark on \p lo threads, then double the number of threads up to \p hi
+inline
+BenchmarkArgs& BenchmarkArgs::ThreadRange (int lo, int hi)
+{
+  int c = lo > 0 ? lo : 1;
+  for (; c < hi; c *= 2)
+    thread_counts.push_back (c);
+  thread_counts.push_back (hi > c / 2 ? hi : c);
+  return *this;
+}
+
+/// Return all argument sets for which the benchmark runs
+inline
+std::vector<std::vector<long long>> BenchmarkArgs::points () const
+{
+  std::vector<std::vector<long long>> pts = sets;
+  if (!dimensions.empty ())
+  {
+    std::vector<std::vector<long long>> prod{ {} };
+    for (auto& dim : dimensions)
+    {
+      std::vector<std::vector<long long>> next;
+      for (auto& p : prod)
+      {
+        for (auto v : dim)
+        {
+          next.push_back (p);
+          next.back ().push_back (v);
+        }
+      }
+      prod.swap (next);
+    }
+    pts.insert (pts.end (), prod.begin (), prod.end ());
+  }
+  if (pts.empty ())
+    pts.emplace_back ();
+  return pts;
+}
+
+//------------------ BenchmarkState member functions --------------------------
+
+/// Prepare a measurement loop with the given number of iterations and arguments
+inline
+BenchmarkState::BenchmarkState (size_t iterations, const std::vector<long long>& args)
+  : max_iterations (iterations)
+  , remaining (iterations)
+  , arguments (args)
+  , complexity_n (args.empty () ? 0 : args[0])
+  , started (false)
+  , paused (false)
+  , total (0)
+  , perf (track_perf_counters)
+  , perf_start ()
+  , perf_total ()
+  , histogram (nullptr)
+  , limits (nullptr)
+  , batch (1)
+  , stop (0)
+  , lap_count (0)
+  , lap_start (0)
+  , lap_time (0)
+  , thread (0)
+  , nthreads (1)
+  , barrier (nullptr)
+  , bytes_processed (0)
+  , items_processed (0)
+{
+}
+
+/// Start the measurement loop
+inline
+BenchmarkState::iterator BenchmarkState::begin ()
+{
+  Start ();
+  return iterator (this);
+}
+
+/// Return the end of the measurement loop
+inline
+BenchmarkState::iterator BenchmarkState::end ()
+{
+  return iterator ();
+}
+
+/// Return the i-th argument of the benchmark or 0 if there is no such argument
+inline
+long long BenchmarkState::range (size_t i) const
+{
+  return i < arguments.size () ? arguments[i] : 0;
+}
+
+/*!
+  Return `true` while there are iterations left to run.
+
+  The first call starts the timer; the timer is stopped when the function
+  returns `false`.
+*/
+inline
+bool BenchmarkState::KeepRunning ()
+{
+  if (!started)
+    Start ();
+  if (remaining == stop && !Lap (remaining, stop))
+    return false;
+  --remaining;
+  return true;
+}
+
+/*!
+  Set an upper limit for a latency percentile.
+
+  Use CHECK_LATENCY or CHECK_LATENCY_P99 macros instead of calling this
+  function directly.
+*/
+inline
+void BenchmarkState::ExpectLatency (double percentile, std::chrono::nanoseconds limit,
+  const char* file, int line)
+{
+  if (!limits)
+    return;
+  for (auto& l : *limits)
+  {
+    if (l.line == line && !strcmp (l.file, file))
+      return; //already set in a previous run
+  }
+  AllocPause pause;
+  limits->push_back (LatencyLimit{ percentile, limit, file, line });
+}
+
+/// Stop measuring time. Used to exclude setup code from measurements.
+inline
+void BenchmarkState::PauseTiming ()
+{
+  if (!paused)
+  {
+    total += Elapsed ();
+    if (perf)
+      perf_accumulate (perf_total, perf_start, PerfCounterSet::instance ().read ());
+    paused = true;
+    if (histogram)
+    {
+      auto& src = TimeSource::instance ();
+      lap_time += src.now () - lap_start - src.overhead ();
+    }
+  }
+}
+
+/// Resume measuring time after a call to PauseTiming()
+inline
+void BenchmarkState::ResumeTiming ()
+{
+  if (paused)
+  {
+    paused = false;
+    if (perf)
+      perf_start = PerfCounterSet::instance ().read ();
+    if (histogram)
+      lap_start = TimeSource::instance ().now ();
+    timer.Start ();
+  }
+}
+
+/*!
+  Return time since the timer was started, less the cost of reading the
+  time. The correction matters only for very short measurement loops.
+*/
+inline
+std::chrono::nanoseconds BenchmarkState::Elapsed () const
+{
+  auto t = timer.GetTimeInNs ().count () - TimeSource::instance ().overhead ();
+  return std::chrono::nanoseconds (t > 0 ? t : 0);
+}
+
+inline
+void BenchmarkState::Start ()
+{
+  started = true;
+  paused = false;
+  total = std::chrono::nanoseconds (0);
+  if (perf)
+  {
+    perf_total = PerfCounters ();
+    perf_start = PerfCounterSet::instance ().read ();
+  }
+  stop = NextLap (max_iterations);
+  lap_count = max_iterations;
+  lap_time = 0;
+  if (barrier)
+    barrier->Wait ();
+  if (histogram)
+    lap_start = TimeSource::instance ().now ();
+  timer.Start ();
+}
+
+inline
+void BenchmarkState::Finish ()
+{
+  if (!paused)
+  {
+    total += Elapsed ();
+    if (perf)
+      perf_accumulate (perf_total, perf_start, PerfCounterSet::instance ().read ());
+  }
+  paused = true;
+}
+
+/// Return iteration count at which the next lap ends
+inline
+size_t BenchmarkState::NextLap (size_t count) const
+{
+  return histogram && count > batch ? count - batch : 0;
+}
+
+/*!
+  End a lap of the measurement loop.
+  \param count  Number of iterations left
+  \param next   Iteration count at which the next lap ends
+  \return `false` if there are no iterations left
+
+  In latency benchmarks, the time per iteration of the lap is recorded in
+  the histogram. The last lap also stops the timer.
+*/
+inline
+bool BenchmarkState::Lap (size_t count, size_t& next)
+{
+  if (histogram)
+  {
+    auto& src = TimeSource::instance ();
+    auto t = src.now ();
+    long long d = lap_time - src.overhead ();
+    if (!paused)
+      d += t - lap_start;
+    size_t n = lap_count - count;
+    if (n)
+      histogram->Record (d > 0 ? d / (long long)n : 0, n);
+    lap_start = t;
+    lap_time = 0;
+    lap_count = count;
+  }
+  if (!count)
+  {
+    Finish ();
+    return false;
+  }
+  next = NextLap (count);
+  return true;
+}
+
+//------------------ Benchmark member functions -------------------------------
+
+/*!
+  Constructor.
+  \param name  Benchmark name
+  \param file  Source file where the benchmark is defined
+  \param line  Line number where the benchmark is defined
+  \param args  Benchmark arguments
+
+  Benchmarks are not subject to the global time constraint. Their run time
+  is determined by `benchmark_min_time` and `benchmark_repetitions`.
+*/
+inline
+Benchmark::Benchmark (const Symbol& name, const char* file, int line,
+  const BenchmarkArgs& args)
+  : Test (name)
+  , filename (file)
+  , line_number (line)
+  , arguments (args)
+  , nthreads (0)
+  , loop_started (false)
+{
+  no_time_constraint ();
+}
+
+/// Return benchmark results, one for each set of arguments
+inline
+const std::vector<BenchmarkStats>& Benchmark::benchmark_results () const
+{
+  return results;
+}
+
+/*!
+  Run the benchmark body once with the given number of iterations.
+
+  Problem size and performance counters are stored in \p stats.
+*/
+inline
+std::chrono::nanoseconds Benchmark::Measure (size_t iterations,
+  const std::vector<long long>& args, BenchmarkStats& stats)
+{
+  if (nthreads > 1)
+    return MeasureThreads (iterations, args, stats);
+
+  BenchmarkState state (iterations, args);
+  state.histogram = latency.get ();
+  state.batch = arguments.latency_batch ();
+  state.limits = &latency_limits;
+  state.nthreads = 1;
+  RunBenchmark (state);
+  loop_started = state.started;
+  stats.complexity_n = state.complexity ();
+  perf_accumulate (stats.perf, PerfCounters (), state.perf_counters ());
+  stats.bytes = (double)state.bytes () / iterations;
+  stats.items = (double)state.items () / iterations;
+  auto t = state.elapsed ();
+  if (t.count () > 0)
+    stats.thread_rate += iterations * 1e9 / t.count ();
+  return t;
+}
+
+/*!
+  Run the benchmark body on `nthreads` threads, each one doing the given
+  number of iterations.
+
+  The calling thread is thread 0. Only this thread records latencies and
+  performance counters. Each thread measures its own time, so threads do not
+  share any data while in the measurement loop. Exceptions thrown by the
+  benchmark body are rethrown after all threads have finished. Failures of
+  the other threads are saved and reported by the calling thread after they
+  finish. Bytes and items processed are summed over all threads.
+
+  \return Time of the slowest thread
+*/
+inline
+std::chrono::nanoseconds Benchmark::MeasureThreads (size_t iterations,
+  const std::vector<long long>& args, BenchmarkStats& stats)
+{
+  std::vector<long long> elapsed, bytes, items;
+  std::vector<char> started;
+  std::vector<std::exception_ptr> errors;
+  std::vector<std::vector<Failure>> failed;
+  std::vector<std::thread> workers;
+  {
+    AllocPause pause;
+    elapsed.resize (nthreads);
+    bytes.resize (nthreads);
+    items.resize (nthreads);
+    started.resize (nthreads);
+    errors.resize (nthreads);
+    failed.resize (nthreads);
+    workers.reserve (nthreads - 1);
+  }
+  SpinBarrier barrier (nthreads);
+
+  auto body = [&](int idx) {
+    BenchmarkState state (iterations, args);
+    state.thread = idx;
+    state.nthreads = nthreads;
+    state.barrier = &barrier;
+    if (idx == 0)
+    {
+      state.histogram = latency.get ();
+      state.batch = arguments.latency_batch ();
+      state.limits = &latency_limits;
+    }
+    else
+    {
+      state.perf = false;
+      deferred_failures () = &failed[idx];
+    }
+    try {
+      RunBenchmark (state);
+    }
+    catch (...) {
+      errors[idx] = std::current_exception ();
+    }
+    deferred_failures () = nullptr;
+    started[idx] = state.started;
+    if (!state.started)
+      barrier.Wait (); //don't leave other threads waiting
+    elapsed[idx] = state.elapsed ().count ();
+    bytes[idx] = state.bytes ();
+    items[idx] = state.items ();
+    if (idx == 0)
+    {
+      stats.complexity_n = state.complexity ();
+      perf_accumulate (stats.perf, PerfCounters (), state.perf_counters ());
+    }
+  };
+
+  {
+    AllocPause pause;
+    for (int i = 1; i < nthreads; ++i)
+      workers.emplace_back (body, i);
+  }
+  body (0);
+  for (auto& w : workers)
+    w.join ();
+
+  for (auto& list : failed)
+  {
+    for (auto& f : list)
+      ReportFailure (f.filename, f.line_number, f.message);
+  }
+  for (auto& e : errors)
+  {
+    if (e)
+      std::rethrow_exception (e);
+  }
+  loop_started = std::find (started.begin (), started.end (), 1) != started.end ();
+
+  long long slowest = 0;
+  double rate = 0;
+  stats.bytes = stats.items = 0;
+  for (int i = 0; i < nthreads; ++i)
+  {
+    auto t = elapsed[i];
+    if (t > slowest)
+      slowest = t;
+    if (t > 0)
+      rate += iterations * 1e9 / t;
+    stats.bytes += (double)bytes[i] / iterations;
+    stats.items += (double)items[i] / iterations;
+  }
+  stats.thread_rate += rate / nthreads;
+  return std::chrono::nanoseconds (slowest);
+}
+
+/*!
+  Run the benchmark for each set of arguments and send the results to the
+  current reporter.
+
+  If the benchmark reports any failures, it is stopped.
+*/
+inline
+void Benchmark::RunImpl ()
+{
+  std::vector<std::vector<long long>> points;
+  std::vector<int> counts;
+  std::vector<double> times;
+  {
+    AllocPause pause; //not allocations of the benchmark
+    benchmark_environment ();
+    points = arguments.points ();
+    counts = arguments.threads ();
+    if (counts.empty ())
+      counts.push_back (0);
+    times.resize (benchmark_repetitions > 0 ? benchmark_repetitions : 1);
+    results.clear ();
+    results.reserve (points.size () * counts.size ());
+    latency_limits.clear ();
+    if (arguments.latency_batch ())
+      latency.reset (new LatencyHistogram);
+  }
+
+  //threads inherit CPU affinity; multithreaded benchmarks are not pinned
+  bool threaded = !arguments.threads ().empty ();
+  BenchmarkIsolation isolation (threaded ? -1 : benchmark_cpu, benchmark_high_priority);
+  for (auto& p : points)
+  {
+    size_t first = results.size (); //results of first thread count
+    for (auto c : counts)
+    {
+      nthreads = c;
+      BenchmarkStats stats{};
+      if (!RunArgs (p, times, stats))
+        return;
+
+      AllocPause pause;
+      std::string key = CurrentSuite.str () + "::" + test_name ();
+      for (auto a : p)
+        key += '/' + std::to_string (a);
+      if (threaded)
+        key += "/threads:" + std::to_string (c);
+
+      stats.threads = c;
+      stats.thread_rate /= stats.repetitions;
+      stats.total_rate = stats.median > 0 ? (c > 1 ? c : 1) * 1e9 / stats.median : 0.;
+      stats.efficiency = 1.;
+      if (results.size () > first && stats.median > 0)
+        stats.efficiency = results[first].median / stats.median;
+      if (stats.median > 0)
+      {
+        stats.bytes_rate = stats.bytes * 1e9 / stats.median;
+        stats.items_rate = stats.items * 1e9 / stats.median;
+      }
+
+      benchmark_baseline.Compare (key, stats);
+      results.push_back (stats);
+      CurrentReporter->ReportBenchmark (results.back ());
+
+      auto& cmp = stats.comparison;
+      if (cmp.verdict == vSlower && benchmark_baseline.fail_on_regression)
+      {
+        std::ostringstream msg;
+        msg.setf (std::ios::fixed);
+        msg.precision (2);
+        msg << "Benchmark " << key;
+        if (cmp.metric == mTime)
+          msg << " is slower than baseline by " << cmp.delta * 100 << '%';
+        else
+          msg << " throughput is lower than baseline by " << -cmp.delta * 100 << '%';
+        msg << " (confidence " << (1 - cmp.p_value) * 100 << "%)";
+        ReportFailure (filename, line_number, msg.str ());
+      }
+      CheckLatency ();
+    }
+  }
+
+  if (arguments.complexity () != oNone && points.size () > 1)
+    CheckComplexity ();
+}
+
+/*!
+  Calibrate the number of iterations and run all repetitions for one set of
+  arguments.
+
+  Calibration starts with one iteration and increases the number of
+  iterations until a run takes at least `benchmark_min_time`. The benchmark
+  then runs for `benchmark_warmup` before measurements start.
+
+  A benchmark fails if it doesn't enter its measurement loop or if no time
+  is measured, for instance because timing is paused for the whole loop.
+  Calibration and warmup are limited by wall-clock time, so that they end
+  even if the measured time is 0.
+
+  \return `false` if the benchmark has failed
+*/
+inline
+bool Benchmark::RunArgs (const std::vector<long long>& args,
+  std::vector<double>& times, BenchmarkStats& stats)
+{
+  using namespace std::chrono;
+  auto target = duration_cast<nanoseconds>(benchmark_min_time).count ();
+  size_t n = 1;
+  long long t;
+  for (;;)
+  {
+    auto run_start = steady_clock::now ();
+    t = Measure (n, args, stats).count ();
+    if (failures)
+      return false;
+    if (!loop_started)
+    {
+      AllocPause pause;
+      ReportFailure (filename, line_number,
+        "Benchmark " + test_name () + " does not run its measurement loop");
+      return false;
+    }
+    if (t >= target || n >= BENCHMARK_MAX_ITERATIONS
+     || (t == 0 && steady_clock::now () - run_start >= nanoseconds (target)))
+      break;
+
+    //aim 40% over target but do not grow more than 10 times in one step
+    double mult = t > 0 ? 1.4 * target / t : 10.;
+    if (mult > 10.)
+      mult = 10.;
+    size_t next = (size_t)(n * mult);
+    n = next > n ? next : n + 1;
+    if (n > BENCHMARK_MAX_ITERATIONS)
+      n = BENCHMARK_MAX_ITERATIONS;
+  }
+
+  if (t == 0)
+  {
+    AllocPause pause;
+    ReportFailure (filename, line_number,
+      "Benchmark " + test_name () + " has not measured any time");
+    return false;
+  }
+
+  //warm up caches and branch predictors
+  auto warmup_end = steady_clock::now () + duration_cast<nanoseconds>(benchmark_warmup);
+  while (steady_clock::now () < warmup_end)
+  {
+    Measure (n, args, stats);
+    if (failures)
+      return false;
+  }
+
+  stats.perf = PerfCounters (); //calibration and warmup runs are not counted
+  stats.thread_rate = 0;
+  if (latency)
+    latency->Clear ();
+  for (auto& r : times)
+  {
+    r = (double)Measure (n, args, stats).count () / n;
+    if (failures)
+      return false;
+  }
+
+  {
+    AllocPause pause;
+    stats.args = args;
+    stats.samples = times;
+  }
+  stats.iterations = n;
+  stats.repetitions = (int)times.size ();
+  double sum = 0;
+  for (auto s : times)
+    sum += s;
+  stats.mean = sum / times.size ();
+  double sq = 0;
+  for (auto s : times)
+    sq += (s - stats.mean) * (s - stats.mean);
+  stats.stddev = times.size () > 1 ? sqrt (sq / (times.size () - 1)) : 0.;
+
+  std::sort (times.begin (), times.end ());
+  size_t mid = times.size () / 2;
+  stats.median = times.size () % 2 ? times[mid] : (times[mid - 1] + times[mid]) / 2;
+  stats.min = times.front ();
+  if (latency)
+  {
+    stats.latency = LatencyStats{ latency->count (), latency->percentile (50),
+      latency->percentile (90), latency->percentile (99), latency->percentile (99.9),
+      latency->max () };
+  }
+  return true;
+}
+
+/// Fit results to a complexity class and compare with the declared one
+inline
+void Benchmark::CheckComplexity ()
+{
+  AllocPause pause;
+  std::vector<BenchmarkStats> fitted; //only results for first thread count
+  for (auto& r : results)
+  {
+    if (r.threads == results.front ().threads)
+      fitted.push_back (r);
+  }
+  ComplexityFit fit = fit_complexity (fitted);
+  CurrentReporter->ReportComplexity (fit);
+
+  BigO expected = arguments.complexity ();
+  if (expected != oAuto && fit.big_o > expected)
+  {
+    std::string msg = "Complexity check failed - expected ";
+    msg += big_o_name (expected);
+    msg += " but was ";
+    msg += big_o_name (fit.big_o);
+    ReportFailure (filename, line_number, msg);
+  }
+}
+
+/// Compare latency percentiles of last results with limits set by CHECK_LATENCY macros
+inline
+void Benchmark::CheckLatency ()
+{
+  AllocPause pause;
+  for (auto& l : latency_limits)
+  {
+    std::ostringstream msg;
+    msg << "Latency check failed - ";
+    if (!latency || !latency->count ())
+    {
+      msg << "latency not measured";
+      ReportFailure (l.file, l.line, msg.str ());
+      continue;
+    }
+    std::chrono::nanoseconds actual (latency->percentile (l.percentile));
+    if (actual >= l.limit)
+    {
+      msg << "expected p" << l.percentile << " below " << duration_string (l.limit)
+        << " but was " << duration_string (actual);
+      ReportFailure (l.file, l.line, msg.str ());
+    }
+  }
+}
+
+} //namespace UnitTest
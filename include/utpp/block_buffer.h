@@ -0,0 +1,225 @@
+#pragma once
+/*
+  UTPP - A New Generation of UnitTest++
+  (c) Mircea Neacsu 2017-2025
+
+  See LICENSE file for full copyright information.
+*/
+
+/*!
+  \file block_buffer.h
+  \brief Definition of UnitTest::BlockBuffer class
+
+  A BlockBuffer collects output in a large block of memory and passes it to
+  another stream buffer only when the block is full or when it is flushed.
+  Many small writes become a single large one.
+
+  Output that is still in the buffer would be lost if the program crashes.
+  While a block buffer exists, `std::terminate` and the handlers for fatal
+  signals (`SIGSEGV`, `SIGABRT`, `SIGFPE`, `SIGILL`) flush all block
+  buffers before calling the previous handler. Flushing from a signal handler
+  is not async-signal-safe; it is done on a best effort basis.
+*/
+
+#include <streambuf>
+#include <vector>
+#include <csignal>
+#include <exception>
+
+namespace UnitTest {
+
+/// Stream buffer that passes output to another stream buffer in large blocks
+class BlockBuffer : public std::streambuf
+{
+public:
+  BlockBuffer (std::streambuf* dest, size_t size);
+  ~BlockBuffer ();
+
+  static void FlushAll ();
+
+protected:
+  int_type overflow (int_type c) override;
+  int sync () override;
+
+private:
+  BlockBuffer (const BlockBuffer&) = delete;
+  BlockBuffer& operator= (const BlockBuffer&) = delete;
+
+  bool WriteOut ();
+
+  static BlockBuffer*& first ();
+  static void InstallHandlers (bool on);
+  static void OnSignal (int sig);
+  static void OnTerminate ();
+
+  std::streambuf* dest;     ///< Final destination of output
+  std::vector<char> block;  ///< Buffered output
+  BlockBuffer* next;        ///< Next buffer in list of all buffers
+};
+
+/*!
+  Constructor.
+  \param dest   Stream buffer that receives the output
+  \param size   Size of memory block
+*/
+inline
+BlockBuffer::BlockBuffer (std::streambuf* dest_, size_t size)
+  : dest (dest_)
+  , block (size ? size : 1)
+  , next (first ())
+{
+  setp (block.data (), block.data () + block.size ());
+  if (!first ())
+    InstallHandlers (true);
+  first () = this;
+}
+
+/// Destructor. Writes out remaining output.
+inline
+BlockBuffer::~BlockBuffer ()
+{
+  sync ();
+  for (auto p = &first (); *p; p = &(*p)->next)
+  {
+    if (*p == this)
+    {
+      *p = next;
+      break;
+    }
+  }
+  if (!first ())
+    InstallHandlers (false);
+}
+
+/// Write buffered output to destination
+inline
+bool BlockBuffer::WriteOut ()
+{
+  auto n = pptr () - pbase ();
+  bool ok = (n == 0 || dest->sputn (pbase (), n) == n);
+  setp (block.data (), block.data () + block.size ());
+  return ok;
+}
+
+/// Called when block is full
+inline
+BlockBuffer::int_type BlockBuffer::overflow (int_type c)
+{
+  if (!WriteOut ())
+    return traits_type::eof ();
+  if (!traits_type::eq_int_type (c, traits_type::eof ()))
+  {
+    *pptr () = traits_type::to_char_type (c);
+    pbump (1);
+  }
+  return traits_type::not_eof (c);
+}
+
+/// Write buffered output and flush destination
+inline
+int BlockBuffer::sync ()
+{
+  return (WriteOut () && dest->pubsync () == 0) ? 0 : -1;
+}
+
+/// Flush all existing block buffers
+inline
+void BlockBuffer::FlushAll ()
+{
+  for (auto p = first (); p; p = p->next)
+    p->sync ();
+}
+
+/// Return head of list of all block buffers
+inline
+BlockBuffer*& BlockBuffer::first ()
+{
+  static BlockBuffer* head = nullptr;
+  return head;
+}
+
+/// Number of fatal signals that flush block buffers
+const size_t CRASH_SIGNALS = 4;
+
+/// Return fatal signals that flush block buffers
+inline
+const int* crash_signals ()
+{
+  static const int sigs[CRASH_SIGNALS] = { SIGSEGV, SIGABRT, SIGFPE, SIGILL };
+  return sigs;
+}
+
+/// Handlers that were installed before the block buffer handlers
+struct CrashHandlers
+{
+  void (*on_signal[CRASH_SIGNALS])(int);
+  std::terminate_handler on_terminate;
+};
+
+/// Return handlers that were installed before the block buffer handlers
+inline
+CrashHandlers& previous_crash_handlers ()
+{
+  static CrashHandlers prev;
+  return prev;
+}
+
+/*!
+  Install or remove handlers that flush buffers when program crashes.
+
+  When removing handlers, a handler is restored only if it has not been
+  replaced in the meantime.
+*/
+inline
+void BlockBuffer::InstallHandlers (bool on)
+{
+  auto& prev = previous_crash_handlers ();
+  for (size_t i = 0; i < CRASH_SIGNALS; ++i)
+  {
+    int sig = crash_signals ()[i];
+    if (on)
+      prev.on_signal[i] = std::signal (sig, OnSignal);
+    else
+    {
+      auto current = std::signal (sig, prev.on_signal[i]);
+      if (current != OnSignal)
+        std::signal (sig, current);
+    }
+  }
+  if (on)
+    prev.on_terminate = std::set_terminate (OnTerminate);
+  else
+  {
+    auto current = std::set_terminate (prev.on_terminate);
+    if (current != OnTerminate)
+      std::set_terminate (current);
+  }
+}
+
+/// Handler for fatal signals: flush buffers and raise signal again with previous handler
+inline
+void BlockBuffer::OnSignal (int sig)
+{
+  FlushAll ();
+  auto handler = SIG_DFL;
+  for (size_t i = 0; i < CRASH_SIGNALS; ++i)
+  {
+    if (crash_signals ()[i] == sig && previous_crash_handlers ().on_signal[i] != SIG_ERR)
+      handler = previous_crash_handlers ().on_signal[i];
+  }
+  std::signal (sig, handler);
+  std::raise (sig);
+}
+
+/// Terminate handler: flush buffers and call previous terminate handler
+inline
+void BlockBuffer::OnTerminate ()
+{
+  FlushAll ();
+  auto prev = previous_crash_handlers ().on_terminate;
+  if (prev)
+    prev ();
+  std::abort ();
+}
+
+} //namespace UnitTest
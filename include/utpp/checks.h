@@ -20,6 +20,11 @@
 #include <cmath>
 #include <cstring>
 #include <sys/stat.h>
+#include <type_traits>
+#if UTPP_CPP_LANG >= 201703L
+#include <charconv>
+#include <system_error>
+#endif
 
 /*!
   \ingroup checks
@@ -38,14 +43,11 @@
 #define CHECK(value)                                                          \
   do                                                                          \
   {                                                                           \
-    try {                                                                     \
-      if (!UnitTest::Check(value))                                            \
-        UnitTest::ReportFailure (__FILE__, __LINE__, "Check failed: " #value);\
-    }                                                                         \
-    catch (...) {                                                             \
-      UnitTest::ReportFailure (__FILE__, __LINE__,                            \
-        "Unhandled exception in CHECK(" #value ")");                          \
-    }                                                                         \
+    static constexpr UnitTest::CheckSite site__{ __FILE__, __LINE__,          \
+      "CHECK", #value };                                                      \
+    if (UnitTest::EvalCheck (site__, [&](std::string&) {                      \
+          return UnitTest::Check(value); })) UTPP_UNLIKELY                    \
+      UnitTest::ReportCheckFailure (site__);                                  \
   } while (0)
 
 /*!
@@ -60,17 +62,11 @@
 #define CHECK_EX(value, ...)                                                  \
   do                                                                          \
   {                                                                           \
-    try {                                                                     \
-      if (!UnitTest::Check(value)){                                           \
-        char message[UnitTest::MAX_MESSAGE_SIZE];                             \
-        snprintf (message, UnitTest::MAX_MESSAGE_SIZE, __VA_ARGS__);          \
-        UnitTest::ReportFailure (__FILE__, __LINE__, message);                \
-      }                                                                       \
-    }                                                                         \
-    catch (...) {                                                             \
-      UnitTest::ReportFailure (__FILE__, __LINE__,                            \
-        "Unhandled exception in CHECK_EX(" #value ")");                       \
-    }                                                                         \
+    static constexpr UnitTest::CheckSite site__{ __FILE__, __LINE__,          \
+      "CHECK_EX", #value };                                                   \
+    if (UnitTest::EvalCheck (site__, [&](std::string&) {                      \
+          return UnitTest::Check(value); })) UTPP_UNLIKELY                    \
+      UnitTest::ReportFailuref (site__, __VA_ARGS__);                         \
   } while (0)
 
 /*!
@@ -86,15 +82,11 @@
 #define CHECK_EQUAL(expected, actual)                                         \
   do                                                                          \
   {                                                                           \
-    try {                                                                     \
-      std::string str__;                                                      \
-      if (!UnitTest::CheckEqual((expected), (actual), str__))                 \
-        UnitTest::ReportFailure (__FILE__, __LINE__, str__);                  \
-    }                                                                         \
-    catch (...) {                                                             \
-      UnitTest::ReportFailure (__FILE__, __LINE__,                            \
-        "Unhandled exception in CHECK_EQUAL(" #expected ", " #actual ")");    \
-    }                                                                         \
+    static constexpr UnitTest::CheckSite site__{ __FILE__, __LINE__,          \
+      "CHECK_EQUAL", #expected ", " #actual };                                \
+    if (auto msg__ = UnitTest::EvalCheck (site__, [&](std::string& str__) {   \
+          return UnitTest::CheckEqual((expected), (actual), str__); })) UTPP_UNLIKELY \
+      UnitTest::ReportFailure (site__, *msg__);                               \
   } while (0)
 
 /*!
@@ -110,20 +102,17 @@
 #define CHECK_NAN(value)                                                      \
   do                                                                          \
   {                                                                           \
-    try {                                                                     \
-      if (!UnitTest::CheckNaN(value))                                         \
-        UnitTest::ReportFailure (__FILE__, __LINE__, "Check failed: " #value " is not NaN");\
-    }                                                                         \
-    catch (...) {                                                             \
-      UnitTest::ReportFailure (__FILE__, __LINE__,                            \
-        "Unhandled exception in CHECK_NAN(" #value ")");                      \
-    }                                                                         \
+    static constexpr UnitTest::CheckSite site__{ __FILE__, __LINE__,          \
+      "CHECK_NAN", #value };                                                  \
+    if (UnitTest::EvalCheck (site__, [&](std::string&) {                      \
+          return UnitTest::CheckNaN(value); })) UTPP_UNLIKELY                 \
+      UnitTest::ReportCheckFailure (site__, " is not NaN");                   \
   } while (0)
 
 /*!
   \def CHECK_EQUAL_EX
   \brief  Generate a failure if actual value is different from expected.
-          The given message is appended to the standard CHECK_EQUAL message. 
+          The given message is appended to the standard CHECK_EQUAL message.
 
   \hideinitializer
 */
@@ -133,21 +122,11 @@
 #define CHECK_EQUAL_EX(expected, actual, ...)                                 \
   do                                                                          \
   {                                                                           \
-    try {                                                                     \
-      std::string str__;                                                      \
-      if (!UnitTest::CheckEqual((expected), (actual), str__))                 \
-      {                                                                       \
-        char message[UnitTest::MAX_MESSAGE_SIZE];                             \
-        snprintf (message, UnitTest::MAX_MESSAGE_SIZE, __VA_ARGS__);          \
-        str__ += " - ";                                                       \
-        str__ += message;                                                     \
-        UnitTest::ReportFailure (__FILE__, __LINE__, str__);                  \
-      }                                                                       \
-    }                                                                         \
-    catch (...) {                                                             \
-      UnitTest::ReportFailure (__FILE__, __LINE__,                            \
-        "Unhandled exception in CHECK_EQUAL_EX(" #expected ", " #actual ")"); \
-    }                                                                         \
+    static constexpr UnitTest::CheckSite site__{ __FILE__, __LINE__,          \
+      "CHECK_EQUAL_EX", #expected ", " #actual };                             \
+    if (auto msg__ = UnitTest::EvalCheck (site__, [&](std::string& str__) {   \
+          return UnitTest::CheckEqual((expected), (actual), str__); })) UTPP_UNLIKELY \
+      UnitTest::ReportFailureEx (site__, *msg__, __VA_ARGS__);                \
   } while (0)
 
 /*!
@@ -164,19 +143,11 @@
 #define CHECK_CLOSE(expected, actual,...)                                     \
   do                                                                          \
   {                                                                           \
-    try {                                                                     \
-      std::string str__;                                                      \
-      if (!UnitTest::CheckClose ((expected), (actual), (__VA_ARGS__+0), str__)) \
-        UnitTest::ReportFailure (__FILE__, __LINE__, str__);                  \
-    }                                                                         \
-    catch (UnitTest::tolerance_not_set&)                                      \
-    {                                                                         \
-      throw UnitTest::test_abort (__FILE__, __LINE__, "UnitTest::default_tolerance not set"); \
-    }                                                                         \
-    catch (...) {                                                             \
-      UnitTest::ReportFailure (__FILE__, __LINE__,                            \
-        "Unhandled exception in CHECK_CLOSE(" #expected ", " #actual ")");    \
-    }                                                                         \
+    static constexpr UnitTest::CheckSite site__{ __FILE__, __LINE__,          \
+      "CHECK_CLOSE", #expected ", " #actual };                                \
+    if (auto msg__ = UnitTest::EvalCheck (site__, [&](std::string& str__) {   \
+          return UnitTest::CheckClose ((expected), (actual), (__VA_ARGS__+0), str__); })) UTPP_UNLIKELY \
+      UnitTest::ReportFailure (site__, *msg__);                               \
   } while (0)
 
 /*!
@@ -193,25 +164,11 @@
 #define CHECK_CLOSE_EX(expected, actual, tolerance, ...)                      \
   do                                                                          \
   {                                                                           \
-    try {                                                                     \
-      std::string str__;                                                      \
-      if (!UnitTest::CheckClose ((expected), (actual), (tolerance), str__))   \
-      {                                                                       \
-        char message[UnitTest::MAX_MESSAGE_SIZE];                             \
-        snprintf (message, UnitTest::MAX_MESSAGE_SIZE, __VA_ARGS__);          \
-        str__ += " - ";                                                       \
-        str__ += message;                                                     \
-        UnitTest::ReportFailure (__FILE__, __LINE__, str__);                  \
-      }                                                                       \
-    }                                                                         \
-    catch (UnitTest::tolerance_not_set&)                                      \
-    {                                                                         \
-      throw UnitTest::test_abort (__FILE__, __LINE__, "UnitTest::default_tolerance not set"); \
-    }                                                                         \
-    catch (...) {                                                             \
-      UnitTest::ReportFailure (__FILE__, __LINE__,                            \
-        "Unhandled exception in CHECK_CLOSE_EX(" #expected ", " #actual ")"); \
-    }                                                                         \
+    static constexpr UnitTest::CheckSite site__{ __FILE__, __LINE__,          \
+      "CHECK_CLOSE_EX", #expected ", " #actual };                             \
+    if (auto msg__ = UnitTest::EvalCheck (site__, [&](std::string& str__) {   \
+          return UnitTest::CheckClose ((expected), (actual), (tolerance), str__); })) UTPP_UNLIKELY \
+      UnitTest::ReportFailureEx (site__, *msg__, __VA_ARGS__);                \
   } while (0)
 
 /*!
@@ -224,18 +181,14 @@
 #error Macro CHECK_ARRAY_EQUAL is already defined
 #endif
 
-#define CHECK_ARRAY_EQUAL(expected, actual, count) \
+#define CHECK_ARRAY_EQUAL(expected, actual, count)                            \
   do                                                                          \
   {                                                                           \
-    try {                                                                     \
-      std::string str__;                                                      \
-      if (!UnitTest::CheckArrayEqual ((expected), (actual), (count), str__))  \
-        UnitTest::ReportFailure (__FILE__, __LINE__, str__);                  \
-    }                                                                         \
-    catch (...) {                                                             \
-      UnitTest::ReportFailure (__FILE__, __LINE__,                            \
-       "Unhandled exception in CHECK_ARRAY_EQUAL(" #expected ", " #actual ")"); \
-    }                                                                         \
+    static constexpr UnitTest::CheckSite site__{ __FILE__, __LINE__,          \
+      "CHECK_ARRAY_EQUAL", #expected ", " #actual };                          \
+    if (auto msg__ = UnitTest::EvalCheck (site__, [&](std::string& str__) {   \
+          return UnitTest::CheckArrayEqual ((expected), (actual), (count), str__); })) UTPP_UNLIKELY \
+      UnitTest::ReportFailure (site__, *msg__);                               \
   } while (0)
 
 /*!
@@ -252,19 +205,11 @@
 #define CHECK_ARRAY_CLOSE(expected, actual, count, ...)                       \
   do                                                                          \
   {                                                                           \
-    try {                                                                     \
-      std::string str__;                                                      \
-      if (!UnitTest::CheckArrayClose ((expected), (actual), (count), (__VA_ARGS__+0), str__)) \
-        UnitTest::ReportFailure (__FILE__, __LINE__, str__);                  \
-    }                                                                         \
-    catch (UnitTest::tolerance_not_set&)                                      \
-    {                                                                         \
-      throw UnitTest::test_abort (__FILE__, __LINE__, "UnitTest::default_tolerance not set"); \
-    }                                                                         \
-    catch (...) {                                                             \
-      UnitTest::ReportFailure (__FILE__, __LINE__,                            \
-        "Unhandled exception in CHECK_ARRAY_CLOSE(" #expected ", " #actual ")"); \
-    }                                                                         \
+    static constexpr UnitTest::CheckSite site__{ __FILE__, __LINE__,          \
+      "CHECK_ARRAY_CLOSE", #expected ", " #actual };                          \
+    if (auto msg__ = UnitTest::EvalCheck (site__, [&](std::string& str__) {   \
+          return UnitTest::CheckArrayClose ((expected), (actual), (count), (__VA_ARGS__+0), str__); })) UTPP_UNLIKELY \
+      UnitTest::ReportFailure (site__, *msg__);                               \
   } while (0)
 
 /*!
@@ -281,15 +226,11 @@
 #define CHECK_ARRAY2D_EQUAL(expected, actual, rows, columns)                  \
   do                                                                          \
   {                                                                           \
-    try {                                                                     \
-      std::string str__;                                                      \
-      if (!UnitTest::CheckArray2DEqual ((expected), (actual), (rows), (columns), str__)) \
-        UnitTest::ReportFailure (__FILE__, __LINE__, str__);                  \
-    }                                                                         \
-    catch (...) {                                                             \
-      UnitTest::ReportFailure (__FILE__, __LINE__,                            \
-        "Unhandled exception in CHECK_ARRAY2D_EQUAL(" #expected ", " #actual ")"); \
-    }                                                                         \
+    static constexpr UnitTest::CheckSite site__{ __FILE__, __LINE__,          \
+      "CHECK_ARRAY2D_EQUAL", #expected ", " #actual };                        \
+    if (auto msg__ = UnitTest::EvalCheck (site__, [&](std::string& str__) {   \
+          return UnitTest::CheckArray2DEqual ((expected), (actual), (rows), (columns), str__); })) UTPP_UNLIKELY \
+      UnitTest::ReportFailure (site__, *msg__);                               \
   } while (0)
 
 
@@ -307,19 +248,11 @@
 #define CHECK_ARRAY2D_CLOSE(expected, actual, rows, columns, ...)             \
   do                                                                          \
   {                                                                           \
-    try {                                                                     \
-      std::string str__;                                                      \
-      if (!UnitTest::CheckArray2DClose (expected, actual, rows, columns, (__VA_ARGS__+0), str__)) \
-        UnitTest::ReportFailure (__FILE__, __LINE__, str__);                  \
-    }                                                                         \
-    catch (UnitTest::tolerance_not_set&)                                      \
-    {                                                                         \
-      throw UnitTest::test_abort (__FILE__, __LINE__, "UnitTest::default_tolerance not set"); \
-    }                                                                         \
-    catch (...) {                                                             \
-      UnitTest::ReportFailure (__FILE__, __LINE__,                            \
-        "Unhandled exception in CHECK_ARRAY2D_CLOSE(" #expected ", " #actual ")"); \
-    }                                                                         \
+    static constexpr UnitTest::CheckSite site__{ __FILE__, __LINE__,          \
+      "CHECK_ARRAY2D_CLOSE", #expected ", " #actual };                        \
+    if (auto msg__ = UnitTest::EvalCheck (site__, [&](std::string& str__) {   \
+          return UnitTest::CheckArray2DClose (expected, actual, rows, columns, (__VA_ARGS__+0), str__); })) UTPP_UNLIKELY \
+      UnitTest::ReportFailure (site__, *msg__);                               \
   } while (0)
 
 /*!
@@ -333,19 +266,19 @@
 #ifdef CHECK_THROW
 #error Macro CHECK_THROW is already defined
 #endif
-#define CHECK_THROW(expr, except) \
+#define CHECK_THROW(expr, except)                                             \
   do                                                                          \
   {                                                                           \
+    static constexpr UnitTest::CheckSite site__{ __FILE__, __LINE__,          \
+      "CHECK_THROW", #except };                                               \
     bool caught_ = false;                                                     \
     try { (expr); }                                                           \
     catch (const except& ) { caught_ = true; }                                \
     catch (...) {                                                             \
-      UnitTest::ReportFailure (__FILE__, __LINE__,                            \
-        "Unexpected exception in CHECK_THROW");                               \
+      UnitTest::ReportUnexpectedException (site__);                           \
     }                                                                         \
-    if (!caught_)                                                             \
-      UnitTest::ReportFailure (__FILE__, __LINE__,                            \
-        "Expected exception: \"" #except "\", not thrown");                   \
+    if (!caught_) UTPP_UNLIKELY                                               \
+      UnitTest::ReportNotThrown (site__);                                     \
   } while(0)
 
 /*!
@@ -359,24 +292,19 @@
 #ifdef CHECK_THROW_EX
 #error Macro CHECK_THROW_EX is already defined
 #endif
-#define CHECK_THROW_EX(expr, except, ...) \
+#define CHECK_THROW_EX(expr, except, ...)                                     \
   do                                                                          \
   {                                                                           \
+    static constexpr UnitTest::CheckSite site__{ __FILE__, __LINE__,          \
+      "CHECK_THROW_EX", #except };                                            \
     bool caught_ = false;                                                     \
     try { (expr); }                                                           \
     catch (const except& ) { caught_ = true; }                                \
     catch (...) {                                                             \
-      UnitTest::ReportFailure (__FILE__, __LINE__,                            \
-        "Unexpected exception in CHECK_THROW_EX");                            \
-    }                                                                         \
-    if (!caught_) {                                                           \
-      std::string str__{"Expected exception: \"" #except "\", not thrown"};   \
-      char message[UnitTest::MAX_MESSAGE_SIZE];                               \
-      snprintf (message, UnitTest::MAX_MESSAGE_SIZE, __VA_ARGS__);            \
-      str__ += " - ";                                                         \
-      str__ += message;                                                       \
-      UnitTest::ReportFailure (__FILE__, __LINE__, str__);                    \
+      UnitTest::ReportUnexpectedException (site__);                           \
     }                                                                         \
+    if (!caught_) UTPP_UNLIKELY                                               \
+      UnitTest::ReportNotThrownf (site__, __VA_ARGS__);                       \
   } while(0)
 
 /*!
@@ -393,21 +321,21 @@
 #define CHECK_THROW_EQUAL(expression, value, except)                          \
   do                                                                          \
   {                                                                           \
+    static constexpr UnitTest::CheckSite site__{ __FILE__, __LINE__,          \
+      "CHECK_THROW_EQUAL", #except };                                         \
     bool caught_ = false;                                                     \
     try { expression; }                                                       \
     catch (const except& actual) {                                            \
       caught_ = true;                                                         \
       std::string str__;                                                      \
-      if (!UnitTest::CheckEqual(value, actual, str__))                        \
-        UnitTest::ReportFailure (__FILE__, __LINE__, str__);                  \
+      if (!UnitTest::CheckEqual(value, actual, str__)) UTPP_UNLIKELY          \
+        UnitTest::ReportFailure (site__, str__);                              \
     }                                                                         \
     catch (...) {                                                             \
-      UnitTest::ReportFailure (__FILE__, __LINE__,                            \
-        "Unexpected exception in CHECK_THROW_EQUAL");                         \
+      UnitTest::ReportUnexpectedException (site__);                           \
     }                                                                         \
-    if (!caught_)                                                             \
-      UnitTest::ReportFailure (__FILE__, __LINE__,                            \
-        "Expected exception: \"" #except "\", not thrown");                   \
+    if (!caught_) UTPP_UNLIKELY                                               \
+      UnitTest::ReportNotThrown (site__);                                     \
   } while(0)
 
 /*!
@@ -425,34 +353,21 @@
 #define CHECK_THROW_EQUAL_EX(expression, value, except, ...)                  \
   do                                                                          \
   {                                                                           \
+    static constexpr UnitTest::CheckSite site__{ __FILE__, __LINE__,          \
+      "CHECK_THROW_EQUAL_EX", #except };                                      \
     bool caught_ = false;                                                     \
     try { expression; }                                                       \
     catch (const except& actual) {                                            \
       caught_ = true;                                                         \
       std::string str__;                                                      \
-      if (!UnitTest::CheckEqual(value, actual, str__))                        \
-      {                                                                       \
-        char message[UnitTest::MAX_MESSAGE_SIZE];                             \
-        snprintf (message, UnitTest::MAX_MESSAGE_SIZE, __VA_ARGS__);          \
-        str__ += " - ";                                                       \
-        str__ += message;                                                     \
-        UnitTest::ReportFailure (__FILE__, __LINE__, str__);                  \
-      }                                                                       \
+      if (!UnitTest::CheckEqual(value, actual, str__)) UTPP_UNLIKELY          \
+        UnitTest::ReportFailureEx (site__, str__, __VA_ARGS__);               \
     }                                                                         \
     catch (...) {                                                             \
-      UnitTest::ReportFailure (__FILE__, __LINE__,                            \
-        "Unexpected exception in CHECK_THROW_EQUAL");                         \
-    }                                                                         \
-    if (!caught_)                                                             \
-    {                                                                         \
-      std::string str__{ "Expected exception: \"" #except "\", not thrown" }; \
-      char message[UnitTest::MAX_MESSAGE_SIZE];                               \
-      snprintf (message, UnitTest::MAX_MESSAGE_SIZE, __VA_ARGS__);            \
-      str__ += " - ";                                                         \
-      str__ += message;                                                       \
-      UnitTest::ReportFailure (__FILE__, __LINE__,                            \
-        "Expected exception: \"" #except "\", not thrown");                   \
+      UnitTest::ReportUnexpectedException (site__);                           \
     }                                                                         \
+    if (!caught_) UTPP_UNLIKELY                                               \
+      UnitTest::ReportNotThrownf (site__, __VA_ARGS__);                       \
   } while(0)
 
 /*!
@@ -467,15 +382,11 @@
 #define CHECK_FILE_EQUAL(expected, actual)                                    \
   do                                                                          \
   {                                                                           \
-    try {                                                                     \
-      std::string str__;                                                      \
-      if (!UnitTest::CheckFileEqual((expected), (actual), str__))             \
-        UnitTest::ReportFailure (__FILE__, __LINE__, str__);                  \
-    }                                                                         \
-    catch (...) {                                                             \
-      UnitTest::ReportFailure (__FILE__, __LINE__,                            \
-        "Unhandled exception in CHECK_EQUAL(" #expected ", " #actual ")");    \
-    }                                                                         \
+    static constexpr UnitTest::CheckSite site__{ __FILE__, __LINE__,          \
+      "CHECK_FILE_EQUAL", #expected ", " #actual };                           \
+    if (auto msg__ = UnitTest::EvalCheck (site__, [&](std::string& str__) {   \
+          return UnitTest::CheckFileEqual((expected), (actual), str__); })) UTPP_UNLIKELY \
+      UnitTest::ReportFailure (site__, *msg__);                               \
   } while (0)
 
 /*!
@@ -490,9 +401,92 @@
 #define FAILURE(...)                                                          \
   do                                                                          \
   {                                                                           \
-    char message[UnitTest::MAX_MESSAGE_SIZE];                                 \
-    snprintf (message, UnitTest::MAX_MESSAGE_SIZE, __VA_ARGS__);              \
-    UnitTest::ReportFailure (__FILE__, __LINE__, message);                    \
+    static constexpr UnitTest::CheckSite site__{ __FILE__, __LINE__,          \
+      "FAILURE", "" };                                                        \
+    UnitTest::ReportFailuref (site__, __VA_ARGS__);                           \
+  } while (0)
+
+/*!
+  \def CHECK_FMT
+  \brief Generate a failure with a `std::format` style message if value is 0
+
+  The message is formatted only if the check fails. If the standard library
+  provides `std::format`, the format string is checked at compile time.
+  Otherwise a simplified formatter replaces each `{}` placeholder with the
+  next argument, as written by its stream insertion operator.
+
+  \hideinitializer
+*/
+#ifdef CHECK_FMT
+#error Macro CHECK_FMT is already defined
+#endif
+#define CHECK_FMT(value, ...)                                                 \
+  do                                                                          \
+  {                                                                           \
+    static constexpr UnitTest::CheckSite site__{ __FILE__, __LINE__,          \
+      "CHECK_FMT", #value };                                                  \
+    if (UnitTest::EvalCheck (site__, [&](std::string&) {                      \
+          return UnitTest::Check(value); })) UTPP_UNLIKELY                    \
+      UnitTest::ReportFailureFmt (site__, __VA_ARGS__);                       \
+  } while (0)
+
+/*!
+  \def CHECK_EQUAL_FMT
+  \brief  Generate a failure if actual value is different from expected.
+          The given `std::format` style message is appended to the standard
+          CHECK_EQUAL message.
+
+  \hideinitializer
+*/
+#ifdef CHECK_EQUAL_FMT
+#error Macro CHECK_EQUAL_FMT is already defined
+#endif
+#define CHECK_EQUAL_FMT(expected, actual, ...)                                \
+  do                                                                          \
+  {                                                                           \
+    static constexpr UnitTest::CheckSite site__{ __FILE__, __LINE__,          \
+      "CHECK_EQUAL_FMT", #expected ", " #actual };                            \
+    if (auto msg__ = UnitTest::EvalCheck (site__, [&](std::string& str__) {   \
+          return UnitTest::CheckEqual((expected), (actual), str__); })) UTPP_UNLIKELY \
+      UnitTest::ReportFailureFmtEx (site__, *msg__, __VA_ARGS__);             \
+  } while (0)
+
+/*!
+  \def CHECK_CLOSE_FMT
+  \brief  Generate a failure if actual value differs from expected value with
+          more than given tolerance.
+          The given `std::format` style message is appended to the standard
+          CHECK_CLOSE message.
+  \hideinitializer
+*/
+#ifdef CHECK_CLOSE_FMT
+#error Macro CHECK_CLOSE_FMT is already defined
+#endif
+#define CHECK_CLOSE_FMT(expected, actual, tolerance, ...)                     \
+  do                                                                          \
+  {                                                                           \
+    static constexpr UnitTest::CheckSite site__{ __FILE__, __LINE__,          \
+      "CHECK_CLOSE_FMT", #expected ", " #actual };                            \
+    if (auto msg__ = UnitTest::EvalCheck (site__, [&](std::string& str__) {   \
+          return UnitTest::CheckClose ((expected), (actual), (tolerance), str__); })) UTPP_UNLIKELY \
+      UnitTest::ReportFailureFmtEx (site__, *msg__, __VA_ARGS__);             \
+  } while (0)
+
+/*!
+  \def FAILURE_FMT
+  \brief  Generate a failure with a `std::format` style message
+
+  \hideinitializer
+*/
+#ifdef FAILURE_FMT
+#error Macro FAILURE_FMT is already defined
+#endif
+#define FAILURE_FMT(...)                                                      \
+  do                                                                          \
+  {                                                                           \
+    static constexpr UnitTest::CheckSite site__{ __FILE__, __LINE__,          \
+      "FAILURE_FMT", "" };                                                    \
+    UnitTest::ReportFailureFmt (site__, __VA_ARGS__);                         \
   } while (0)
 
 ///@}
@@ -507,6 +501,669 @@ extern double default_tolerance;
 inline double default_tolerance = 0;
 #endif
 
+//------------------ Failure reporting ---------------------------------------
+
+/*!
+  Static description of a CHECK macro invocation.
+
+  Each CHECK_... macro creates a constant object of this type. Failure messages
+  are assembled from it only when the check fails, by out-of-line functions.
+  This keeps the code generated for a check small.
+*/
+struct CheckSite
+{
+  const char* file;       ///< Name of file containing the check
+  int line;               ///< Line number of check
+  const char* macro;      ///< Name of check macro
+  const char* args;       ///< Text of macro arguments
+};
+
+/*!
+  Report a failure with the given message
+  \param site    Check information
+  \param message Failure message
+*/
+inline UTPP_COLD
+void ReportFailure (const CheckSite& site, const std::string& message)
+{
+  AllocPause pause;
+  ReportFailure (site.file, site.line, message);
+}
+
+/*!
+  Report a failure with the message "Check failed: <arguments>"
+  \param site    Check information
+  \param suffix  Text appended to failure message
+*/
+inline UTPP_COLD
+void ReportCheckFailure (const CheckSite& site, const char* suffix = "")
+{
+  AllocPause pause;
+  ReportFailure (site.file, site.line, std::string ("Check failed: ") + site.args + suffix);
+}
+
+/// Report an exception thrown while evaluating the arguments of a check
+inline UTPP_COLD
+void ReportCheckException (const CheckSite& site)
+{
+  AllocPause pause;
+  ReportFailure (site.file, site.line,
+    std::string ("Unhandled exception in ") + site.macro + '(' + site.args + ')');
+}
+
+/// Report an exception of an unexpected type in a CHECK_THROW... macro
+inline UTPP_COLD
+void ReportUnexpectedException (const CheckSite& site)
+{
+  AllocPause pause;
+  ReportFailure (site.file, site.line, std::string ("Unexpected exception in ") + site.macro);
+}
+
+/*!
+  Report that the expected exception was not thrown in a CHECK_THROW... macro
+  \param site    Check information. Arguments text is the exception type.
+  \param message Optional message appended to the standard message
+*/
+inline UTPP_COLD
+void ReportNotThrown (const CheckSite& site, const char* message = nullptr)
+{
+  AllocPause pause;
+  std::string str{ "Expected exception: \"" };
+  str += site.args;
+  str += "\", not thrown";
+  if (message)
+  {
+    str += " - ";
+    str += message;
+  }
+  ReportFailure (site.file, site.line, str);
+}
+
+/// Abort current test because UnitTest::default_tolerance was not set
+[[noreturn]] inline UTPP_COLD
+void AbortToleranceNotSet (const CheckSite& site)
+{
+  throw test_abort (site.file, site.line, "UnitTest::default_tolerance not set");
+}
+
+/// Function that evaluates the arguments of a check and compares them
+typedef bool (*CheckEvaluator) (const void* ctx, std::string& msg);
+
+/*!
+  Evaluate a check and handle any exception thrown by its arguments.
+  \param site  Check information
+  \param eval  Function that evaluates the check
+  \param ctx   Context passed to `eval`
+  eturn pointer to failure message if the check failed, `nullptr` otherwise
+
+  The exception handling and the failure message string are shared by all
+  checks instead of being expanded by each CHECK_... macro. The message is
+  kept in a thread-local buffer that is valid until the next check.
+*/
+inline UTPP_NOINLINE
+const std::string* EvalCheck (const CheckSite& site, CheckEvaluator eval, const void* ctx)
+{
+  static thread_local std::string msg;
+  try {
+    msg.clear ();
+    if (!eval (ctx, msg)) UTPP_UNLIKELY
+      return &msg;
+  }
+  catch (tolerance_not_set&)
+  {
+    AbortToleranceNotSet (site);
+  }
+  catch (...) {
+    ReportCheckException (site);
+  }
+  return nullptr;
+}
+
+/*!
+  Evaluate a check given as a function object.
+  \param site  Check information
+  \param eval  Function object called with a string that receives the failure
+               message. Returns `true` if the check succeeds.
+  eturn pointer to failure message if the check failed, `nullptr` otherwise
+
+  CHECK_... macros wrap their arguments in a lambda passed to this function.
+  Only a small thunk that calls the lambda is generated for each check.
+*/
+template <typename F>
+const std::string* EvalCheck (const CheckSite& site, const F& eval)
+{
+  return EvalCheck (site, [](const void* ctx, std::string& msg) -> bool {
+    return (*static_cast<const F*>(ctx)) (msg); }, &eval);
+}
+
+//------------------ Message formatting --------------------------------------
+
+/*!
+  Return the buffer used to format failure messages.
+
+  There is one buffer for each thread. It keeps its capacity between failures
+  so there are few allocations even when many failures are reported.
+*/
+inline
+std::string& message_buffer ()
+{
+  static thread_local std::string buf;
+  return buf;
+}
+
+/*!
+  Append printf-formatted text to a string
+  \param str    String that receives the formatted text
+  \param fmt    printf-style format string
+  \param args   Formatting arguments
+
+  There is no limit on the size of the formatted text.
+*/
+inline UTPP_PRINTF_FORMAT (2, 0)
+void vappendf (std::string& str, const char* fmt, va_list args)
+{
+  char tmp[256];
+  va_list args2;
+  va_copy (args2, args);
+  int n = vsnprintf (tmp, sizeof (tmp), fmt, args);
+  if (n >= (int)sizeof (tmp))
+  {
+    size_t pos = str.size ();
+    str.resize (pos + n);
+    vsnprintf (&str[pos], n + 1, fmt, args2);
+  }
+  else if (n > 0)
+    str.append (tmp, n);
+  va_end (args2);
+}
+
+//------------------ Value formatting ----------------------------------------
+
+/// Number format used in failure messages
+struct FormatSpec
+{
+  int precision;            ///< Significant digits or, if `fixed`, decimals
+  bool fixed;               ///< `true` for fixed point notation
+};
+
+/// Default number format. Same as the default format of output streams.
+const FormatSpec default_format = { 6, false };
+
+/*!
+  Return the number of decimals used to show values compared with a given
+  tolerance.
+
+  The result is `1 - log10 (tolerance)` truncated toward 0. For usual
+  tolerance values it is found using a table of powers of 10 instead of
+  calling `log10`.
+*/
+inline
+int tolerance_precision (double tolerance)
+{
+  static const double powers[] = {
+    1e-16, 1e-15, 1e-14, 1e-13, 1e-12, 1e-11, 1e-10, 1e-9, 1e-8, 1e-7, 1e-6,
+    1e-5, 1e-4, 1e-3, 1e-2, 1e-1, 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7,
+    1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16
+  };
+  const int n = (int)(sizeof (powers) / sizeof (powers[0]));
+
+  if (tolerance < powers[0] || tolerance >= powers[n - 1])
+    return (int)(1 - log10 (tolerance));
+
+  //find k such that 10^k <= tolerance < 10^(k+1)
+  int i = 0;
+  while (i < n - 1 && powers[i + 1] <= tolerance)
+    i++;
+  int k = i - 16;
+  if (k <= 0 && tolerance != powers[i])
+    return -k;
+  return 1 - k;
+}
+
+/*!
+  Append the result of a `std::to_chars` conversion to a string
+  \param out    String that receives the text
+  \param args   Value and format arguments for `std::to_chars`
+*/
+#if defined(__cpp_lib_to_chars)
+template <typename... Args>
+void append_chars (std::string& out, Args... args)
+{
+  size_t pos = out.size ();
+  size_t room = 32;
+  for (;;)
+  {
+    out.resize (pos + room);
+    auto r = std::to_chars (&out[pos], &out[0] + out.size (), args...);
+    if (r.ec == std::errc ())
+    {
+      out.resize (r.ptr - out.data ());
+      return;
+    }
+    room *= 2;
+  }
+}
+#endif
+
+/*!
+  Append a formatted floating point value to a string
+  \param out    String that receives the text
+  \param value  Value to format
+  \param spec   Number format
+*/
+template <typename T>
+void append_float (std::string& out, T value, const FormatSpec& spec)
+{
+  int prec = spec.precision < 0 ? 6 : spec.precision;
+#if defined(__cpp_lib_to_chars)
+  append_chars (out, value, spec.fixed ? std::chars_format::fixed
+                                       : std::chars_format::general, prec);
+#else
+  char tmp[64];
+  const char* fmt = spec.fixed ? "%.*Lf" : "%.*Lg";
+  int n = snprintf (tmp, sizeof (tmp), fmt, prec, (long double)value);
+  if (n >= (int)sizeof (tmp))
+  {
+    size_t pos = out.size ();
+    out.resize (pos + n);
+    snprintf (&out[pos], n + 1, fmt, prec, (long double)value);
+  }
+  else if (n > 0)
+    out.append (tmp, n);
+#endif
+}
+
+/// Append an integer value to a string
+template <typename T>
+void append_integer (std::string& out, T value)
+{
+#if defined(__cpp_lib_to_chars)
+  append_chars (out, value);
+#else
+  char tmp[24];
+  if (std::is_signed<T>::value)
+    snprintf (tmp, sizeof (tmp), "%lld", (long long)value);
+  else
+    snprintf (tmp, sizeof (tmp), "%llu", (unsigned long long)value);
+  out += tmp;
+#endif
+}
+
+/*!
+  Converts values to text in failure messages.
+
+  The default implementation uses the stream insertion operator of the type.
+  Users can specialize this template for their own types:
+  ```
+  template <>
+  struct UnitTest::Formatter<Point>
+  {
+    static void format (std::string& out, const Point& p, const UnitTest::FormatSpec& spec)
+    {
+      out += "(";
+      UnitTest::format_value (out, p.x, spec);
+      out += ", ";
+      UnitTest::format_value (out, p.y, spec);
+      out += ")";
+    }
+  };
+  ```
+*/
+template <typename T, typename Enable = void>
+struct Formatter
+{
+  /// Append text representation of `value` to `out`
+  static void format (std::string& out, const T& value, const FormatSpec& spec)
+  {
+    static thread_local std::ostringstream os;
+    os.str (std::string ());
+    os.clear ();
+    os.precision (spec.precision);
+    os.flags (spec.fixed ? std::ios::dec | std::ios::fixed : std::ios::dec);
+    os << value;
+    out += os.str ();
+  }
+};
+
+/// %Formatter for integer types. Character types are handled separately.
+template <typename T>
+struct Formatter<T, typename std::enable_if<std::is_integral<T>::value
+  && !std::is_same<T, bool>::value && !std::is_same<T, char>::value
+  && !std::is_same<T, signed char>::value && !std::is_same<T, unsigned char>::value
+  && !std::is_same<T, wchar_t>::value && !std::is_same<T, char16_t>::value
+  && !std::is_same<T, char32_t>::value>::type>
+{
+  static void format (std::string& out, T value, const FormatSpec&)
+  {
+    append_integer (out, value);
+  }
+};
+
+/// %Formatter for floating point types
+template <typename T>
+struct Formatter<T, typename std::enable_if<std::is_floating_point<T>::value>::type>
+{
+  static void format (std::string& out, T value, const FormatSpec& spec)
+  {
+    append_float (out, value, spec);
+  }
+};
+
+/// %Formatter for `bool` values. Like streams, it shows them as 1 or 0.
+template <>
+struct Formatter<bool>
+{
+  static void format (std::string& out, bool value, const FormatSpec&)
+  {
+    out += value ? '1' : '0';
+  }
+};
+
+/// %Formatter for narrow characters
+template <typename T>
+struct Formatter<T, typename std::enable_if<std::is_same<T, char>::value
+  || std::is_same<T, signed char>::value || std::is_same<T, unsigned char>::value>::type>
+{
+  static void format (std::string& out, T value, const FormatSpec&)
+  {
+    out += (char)value;
+  }
+};
+
+/// %Formatter for C strings
+template <typename T>
+struct Formatter<T, typename std::enable_if<std::is_same<T, const char*>::value
+  || std::is_same<T, char*>::value>::type>
+{
+  static void format (std::string& out, const char* value, const FormatSpec&)
+  {
+    out += value;
+  }
+};
+
+/// %Formatter for strings
+template <>
+struct Formatter<std::string>
+{
+  static void format (std::string& out, const std::string& value, const FormatSpec&)
+  {
+    out += value;
+  }
+};
+
+/*!
+  Append text representation of a value to a string
+  \param out    String that receives the text
+  \param value  Value to format
+  \param spec   Number format
+
+  Arrays decay to pointers so that character arrays are shown as strings.
+*/
+template <typename T>
+void format_value (std::string& out, const T& value, const FormatSpec& spec = default_format)
+{
+  Formatter<typename std::decay<T>::type>::format (out, value, spec);
+}
+
+/*!
+  Builds failure messages in the per-thread message buffer.
+
+  Values are formatted by the Formatter template.
+*/
+class MessageBuilder
+{
+public:
+  explicit MessageBuilder (const FormatSpec& spec = default_format);
+
+  /// Append text or a value to the message
+  template <typename T>
+  MessageBuilder& operator << (const T& value)
+  {
+    format_value (buf, value, spec);
+    return *this;
+  }
+
+  MessageBuilder& hex (unsigned long long value);
+
+  /// Return the message
+  const std::string& str () const { return buf; }
+
+private:
+  MessageBuilder (const MessageBuilder&) = delete;
+  MessageBuilder& operator= (const MessageBuilder&) = delete;
+
+  std::string& buf;
+  FormatSpec spec;
+};
+
+/// Start a new message in the per-thread buffer
+inline
+MessageBuilder::MessageBuilder (const FormatSpec& spec_)
+  : buf (message_buffer ())
+  , spec (spec_)
+{
+  buf.clear ();
+}
+
+/// Append a value in hexadecimal
+inline
+MessageBuilder& MessageBuilder::hex (unsigned long long value)
+{
+#if defined(__cpp_lib_to_chars)
+  append_chars (buf, value, 16);
+#else
+  char tmp[20];
+  snprintf (tmp, sizeof (tmp), "%llx", value);
+  buf += tmp;
+#endif
+  return *this;
+}
+
+/*!
+  Report a failure with a printf-formatted message
+  \param site   Check information
+  \param fmt    printf-style format string
+*/
+inline UTPP_COLD UTPP_PRINTF_FORMAT (2, 3)
+void ReportFailuref (const CheckSite& site, const char* fmt, ...)
+{
+  AllocPause pause;
+  auto& buf = message_buffer ();
+  buf.clear ();
+  va_list args;
+  va_start (args, fmt);
+  vappendf (buf, fmt, args);
+  va_end (args);
+  ReportFailure (site.file, site.line, buf);
+}
+
+/*!
+  Report a failure with a message followed by printf-formatted text
+  \param site   Check information
+  \param msg    Standard failure message
+  \param fmt    printf-style format string
+*/
+inline UTPP_COLD UTPP_PRINTF_FORMAT (3, 4)
+void ReportFailureEx (const CheckSite& site, const std::string& msg, const char* fmt, ...)
+{
+  AllocPause pause;
+  auto& buf = message_buffer ();
+  buf = msg;
+  buf += " - ";
+  va_list args;
+  va_start (args, fmt);
+  vappendf (buf, fmt, args);
+  va_end (args);
+  ReportFailure (site.file, site.line, buf);
+}
+
+/*!
+  Report that the expected exception was not thrown in a CHECK_THROW..._EX
+  macro. The printf-formatted text is appended to the standard message.
+*/
+inline UTPP_COLD UTPP_PRINTF_FORMAT (2, 3)
+void ReportNotThrownf (const CheckSite& site, const char* fmt, ...)
+{
+  AllocPause pause;
+  auto& buf = message_buffer ();
+  buf = "Expected exception: \"";
+  buf += site.args;
+  buf += "\", not thrown - ";
+  va_list args;
+  va_start (args, fmt);
+  vappendf (buf, fmt, args);
+  va_end (args);
+  ReportFailure (site.file, site.line, buf);
+}
+
+/*!
+  Abort current test with a printf-formatted message
+  \param file   Name of file where the test is aborted
+  \param line   Line number where the test is aborted
+  \param fmt    printf-style format string
+*/
+[[noreturn]] inline UTPP_COLD UTPP_PRINTF_FORMAT (3, 4)
+void Abortf (const char* file, int line, const char* fmt, ...)
+{
+  AllocPause pause;
+  auto& buf = message_buffer ();
+  buf.clear ();
+  va_list args;
+  va_start (args, fmt);
+  vappendf (buf, fmt, args);
+  va_end (args);
+  throw test_abort (file, line, buf.c_str ());
+}
+
+#if defined(__cpp_lib_format)
+/// Format string type used by the ..._FMT macros. Checked at compile time.
+template <typename... Args>
+using format_string = std::format_string<Args...>;
+
+/// Append `std::format` formatted text to a string
+template <typename... Args>
+void append_format (std::string& buf, std::format_string<Args...> fmt, Args&&... args)
+{
+  std::vformat_to (std::back_inserter (buf), fmt.get (), std::make_format_args (args...));
+}
+#else
+/// Format string type used by the ..._FMT macros
+template <typename... Args>
+using format_string = const char*;
+
+/*!
+  Copy format string text up to the next replacement field
+  \param buf    String that receives the text
+  \param fmt    Format string. On return it points after the replacement field.
+  \return `true` if a replacement field was found
+
+  Escaped braces (`{{` and `}}`) are copied as single braces. Format
+  specifications inside the replacement field are ignored.
+*/
+inline
+bool format_text (std::string& buf, const char*& fmt)
+{
+  while (*fmt)
+  {
+    if (*fmt == '{')
+    {
+      if (*(fmt + 1) != '{')
+      {
+        const char* end = strchr (fmt, '}');
+        if (end)
+        {
+          fmt = end + 1;
+          return true;
+        }
+      }
+      else
+        fmt++;
+    }
+    else if (*fmt == '}' && *(fmt + 1) == '}')
+      fmt++;
+    buf += *fmt++;
+  }
+  return false;
+}
+
+/// Append rest of format string. Replacement fields without arguments are kept.
+inline
+void append_format (std::string& buf, const char* fmt)
+{
+  while (format_text (buf, fmt))
+    buf += "{}";
+}
+
+/*!
+  Append formatted text to a string.
+
+  Simplified replacement for `std::format`: each replacement field is
+  replaced by the next argument, written using its Formatter.
+*/
+template <typename T, typename... Args>
+void append_format (std::string& buf, const char* fmt, T&& arg, Args&&... args)
+{
+  if (format_text (buf, fmt))
+    format_value (buf, arg);
+  append_format (buf, fmt, std::forward<Args> (args)...);
+}
+#endif
+
+/*!
+  Report a failure with a `std::format` style message
+  \param site   Check information
+  \param fmt    Format string
+  \param args   Formatting arguments
+*/
+template <typename... Args>
+UTPP_COLD
+void ReportFailureFmt (const CheckSite& site, format_string<Args...> fmt, Args&&... args)
+{
+  AllocPause pause;
+  auto& buf = message_buffer ();
+  buf.clear ();
+  append_format (buf, fmt, std::forward<Args> (args)...);
+  ReportFailure (site.file, site.line, buf);
+}
+
+/*!
+  Report a failure with a message followed by `std::format` formatted text
+  \param site   Check information
+  \param msg    Standard failure message
+  \param fmt    Format string
+  \param args   Formatting arguments
+*/
+template <typename... Args>
+UTPP_COLD
+void ReportFailureFmtEx (const CheckSite& site, const std::string& msg,
+                         format_string<Args...> fmt, Args&&... args)
+{
+  AllocPause pause;
+  auto& buf = message_buffer ();
+  buf = msg;
+  buf += " - ";
+  append_format (buf, fmt, std::forward<Args> (args)...);
+  ReportFailure (site.file, site.line, buf);
+}
+
+/*!
+  Abort current test with a `std::format` style message
+  \param file   Name of file where the test is aborted
+  \param line   Line number where the test is aborted
+  \param fmt    Format string
+  \param args   Formatting arguments
+*/
+template <typename... Args>
+[[noreturn]] UTPP_COLD
+void AbortFmt (const char* file, int line, format_string<Args...> fmt, Args&&... args)
+{
+  AllocPause pause;
+  auto& buf = message_buffer ();
+  buf.clear ();
+  append_format (buf, fmt, std::forward<Args> (args)...);
+  throw test_abort (file, line, buf.c_str ());
+}
+
 //------------------ Check functions -----------------------------------------
 
 /*!
@@ -548,7 +1205,8 @@ bool CheckEqual (const expected_T& expected, const actual_T& actual, std::string
 {
   if (!(expected == actual))
   {
-    std::stringstream stream;
+    AllocPause pause;
+    MessageBuilder stream;
     stream << "Expected " << expected << " but was " << actual;
     msg = stream.str ();
     return false;
@@ -563,7 +1221,8 @@ bool CheckEqual (const expected_T* expected, const actual_T* actual, std::string
 {
   if (!(*expected == *actual))
   {
-    std::stringstream stream;
+    AllocPause pause;
+    MessageBuilder stream;
     stream << "Expected " << *expected << " but was " << *actual;
     msg = stream.str ();
     return false;
@@ -591,7 +1250,8 @@ bool CheckEqual (const std::vector<expected_T>& expected, const std::vector<actu
 {
   if (expected != actual)
   {
-    std::stringstream stream;
+    AllocPause pause;
+    MessageBuilder stream;
     stream << "Expected [ ";
     for (auto& p : expected)
       stream << p << " ";
@@ -626,7 +1286,8 @@ bool CheckEqual (const std::array<expected_T,N>& expected, const std::array<actu
 {
   if (expected != actual)
   {
-    std::stringstream stream;
+    AllocPause pause;
+    MessageBuilder stream;
     stream << "Expected [ ";
     for (size_t i = 0; i < N; ++i)
       stream << expected[i] << " ";
@@ -661,7 +1322,8 @@ bool CheckEqual (const std::list<expected_T>& expected, const std::list<actual_T
 {
   if (expected != actual)
   {
-    std::stringstream stream;
+    AllocPause pause;
+    MessageBuilder stream;
     stream << "Expected ( ";
     for (auto const& x : expected)
       stream << x << " ";
@@ -776,7 +1438,8 @@ bool CheckEqual (const std::wstring expected, const std::wstring actual,
 {
   if (expected != actual)
   {
-    std::stringstream stream;
+    AllocPause pause;
+    MessageBuilder stream;
     auto u8exp = to_utf8 (expected);
     auto u8act = to_utf8 (actual);
     stream << "Expected \'" << u8exp << "\' but was \'" << u8act << "\'";
@@ -804,7 +1467,8 @@ bool CheckEqual (const wchar_t *expected, const wchar_t *actual,
 {
   if (wcscmp (expected, actual))
   {
-    std::stringstream stream;
+    AllocPause pause;
+    MessageBuilder stream;
     std::string u8exp = to_utf8 (expected);
     std::string u8act = to_utf8 (actual);
     stream << "Expected \'" << u8exp << "\' but was \'" << u8act << "\'";
@@ -866,7 +1530,8 @@ bool CheckEqual (const char* expected, const char* actual, std::string& msg)
 {
   if (strcmp (expected, actual))
   {
-    std::stringstream stream;
+    AllocPause pause;
+    MessageBuilder stream;
     stream << "Expected \'" << expected << "\' but was \'" << actual << "\'";
     msg = stream.str ();
     return false;
@@ -927,9 +1592,11 @@ bool CheckEqual (char32_t expected, char32_t actual, std::string& msg)
 {
   if (expected != actual)
   {
-    std::stringstream stream;
-    stream << std::hex << "Expected (char32_t)U\'\\x" << static_cast<uint32_t>(expected) 
-      << "\' but was (char32_t)U\'\\x" << static_cast<uint32_t>(actual) << "\'";
+    AllocPause pause;
+    MessageBuilder stream;
+    stream << "Expected (char32_t)U\'\\x";
+    stream.hex (static_cast<uint32_t>(expected)) << "\' but was (char32_t)U\'\\x";
+    stream.hex (static_cast<uint32_t>(actual)) << "\'";
     msg = stream.str ();
     return false;
   }
@@ -981,10 +1648,8 @@ bool CheckClose (const expected_T& expected, const actual_T& actual, double tole
   if (!isClose(actual, expected, tolerance))
   {
     auto fail_tol = tolerance ? tolerance : UnitTest::default_tolerance;
-    int prec = (int)(1 - log10 (fail_tol));
-    std::stringstream stream;
-    stream.precision (prec);
-    stream.setf (std::ios::fixed);
+    AllocPause pause;
+    MessageBuilder stream (FormatSpec{ tolerance_precision (fail_tol), true });
     stream << "Expected " << expected << " +/- " << fail_tol << " but was " << actual;
     msg = stream.str ();
     return false;
@@ -1026,7 +1691,8 @@ bool CheckArrayEqual (const expected_T& expected, const actual_T& actual,
 {
   if (!Equal1D (expected, actual, count))
   {
-    std::stringstream stream;
+    AllocPause pause;
+    MessageBuilder stream;
     stream << "Expected [ ";
     for (size_t i = 0; i < count; ++i)
       stream << expected[i] << " ";
@@ -1086,11 +1752,8 @@ bool CheckArrayClose (const expected_T& expected, const actual_T& actual, size_t
   if (!isClose1D (expected, actual, count, tolerance))
   {
     auto fail_tol = tolerance ? tolerance : UnitTest::default_tolerance;
-    int prec = (int)(1 - log10 (fail_tol));
-
-    std::stringstream stream;
-    stream.precision (prec);
-    stream.setf (std::ios::fixed);
+    AllocPause pause;
+    MessageBuilder stream (FormatSpec{ tolerance_precision (fail_tol), true });
     stream << "Expected [ ";
     for (size_t i = 0; i < count; ++i)
       stream << expected[i] << " ";
@@ -1119,7 +1782,8 @@ inline
 bool CheckEqual<void, void>(const void* expected, const void* actual, std::string& msg)
 {
   if (!(expected == actual)) {
-    std::stringstream stream;
+    AllocPause pause;
+    MessageBuilder stream;
     stream << "Expected " << expected << " but was " << actual;
     msg = stream.str();
     return false;
@@ -1146,10 +1810,8 @@ bool CheckClose (const std::vector<expected_T>& expected, const std::vector<actu
    || !isClose1D (&expected[0], &actual[0], expected.size(), tolerance))
   {
     auto fail_tol = tolerance ? tolerance : UnitTest::default_tolerance;
-    int prec = (int)(1 - log10 (fail_tol));
-    std::stringstream stream;
-    stream.precision (prec);
-    stream.setf (std::ios::fixed);
+    AllocPause pause;
+    MessageBuilder stream (FormatSpec{ tolerance_precision (fail_tol), true });
     stream << "Expected [ ";
     for (auto& p : expected)
       stream << p << " ";
@@ -1181,10 +1843,8 @@ bool CheckClose (const std::array<expected_T, N>& expected, const std::array<act
   if (!isClose1D (&expected[0], &actual[0], N, tolerance))
   {
     auto fail_tol = tolerance ? tolerance : UnitTest::default_tolerance;
-    int prec = (int)(1 - log10 (fail_tol));
-    std::stringstream stream;
-    stream.precision (prec);
-    stream.setf (std::ios::fixed);
+    AllocPause pause;
+    MessageBuilder stream (FormatSpec{ tolerance_precision (fail_tol), true });
     stream << "Expected [ ";
     for (auto& p : expected)
       stream << p << " ";
@@ -1233,7 +1893,8 @@ bool CheckArray2DEqual (const expected_T& expected, const actual_T& actual,
 {
   if (!Equal2D (expected, actual, rows, columns))
   {
-    std::stringstream stream;
+    AllocPause pause;
+    MessageBuilder stream;
     size_t i, j;
     stream << "Expected [\n";
     for (i = 0; i < rows; ++i)
@@ -1298,10 +1959,8 @@ bool CheckArray2DClose (const expected_T& expected, const actual_T& actual,
   if (!isClose2D (expected, actual, rows, columns, tolerance))
   {
     auto fail_tol = tolerance ? tolerance : UnitTest::default_tolerance;
-    int prec = (int)(1 - log10 (fail_tol));
-    std::stringstream stream;
-    stream.precision (prec);
-    stream.setf (std::ios::fixed);
+    AllocPause pause;
+    MessageBuilder stream (FormatSpec{ tolerance_precision (fail_tol), true });
     stream << "Expected [\n";
     size_t i, j;
     for (i = 0; i < rows; ++i)
@@ -1412,15 +2071,11 @@ bool CheckFileEqual (const std::string& ref, const std::string& actual, std::str
 #define EXPECT_NE(A, B)                                                       \
   do                                                                          \
   {                                                                           \
-    try {                                                                     \
-      std::string str__;                                                      \
-      if (UnitTest::CheckEqual ((A), (B), str__))                             \
-        UnitTest::ReportFailure (__FILE__, __LINE__, str__);                  \
-    }                                                                         \
-    catch (...) {                                                             \
-      UnitTest::ReportFailure (__FILE__, __LINE__,                            \
-            "Unhandled exception in CHECK_EQUAL(" #A ", " #B ")");            \
-    }                                                                         \
+    static constexpr UnitTest::CheckSite site__{ __FILE__, __LINE__,          \
+      "CHECK_EQUAL", #A ", " #B };                                            \
+    if (auto msg__ = UnitTest::EvalCheck (site__, [&](std::string& str__) {   \
+          return !UnitTest::CheckEqual ((A), (B), str__); })) UTPP_UNLIKELY   \
+      UnitTest::ReportFailure (site__, *msg__);                               \
   } while (0)
 
 #define EXPECT_GE(A, B) CHECK ((A) >= (B))
@@ -1463,6 +2118,8 @@ bool CheckFileEqual (const std::string& ref, const std::string& actual, std::str
   \defgroup checks  Assertion Checking Macros
   \defgroup tests   Test Definition Macros
   \defgroup time    Time Control Macros
+  \defgroup alloc   Allocation Control Macros
+  \defgroup bench   Benchmark Macros
   \defgroup gt      Compatibility Macros
   \defgroup exec    Execution Control 
 */
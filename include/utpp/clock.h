@@ -0,0 +1,261 @@
+#pragma once
+/*
+  UTPP - A New Generation of UnitTest++
+  (c) Mircea Neacsu 2017-2025
+
+  See LICENSE file for full copyright information.
+*/
+
+/*!
+  \file clock.h
+  \brief Time sources used by UnitTest::Timer
+
+  On x86 processors with an invariant time stamp counter (TSC) and the RDTSCP
+  instruction, timers read the TSC directly. Its frequency is calibrated
+  against `std::chrono::steady_clock` the first time a timer is used.
+  Otherwise, on Linux, timers use `clock_gettime (CLOCK_MONOTONIC_RAW)` and,
+  on other systems, `std::chrono::steady_clock`.
+
+  The time source can be changed before running the tests:
+  ```
+  UnitTest::TimeSource::instance ().select (UnitTest::TimeSource::steady);
+  ```
+  The overhead of reading the time source is measured when the source is
+  selected and benchmarks subtract it from their measurements.
+*/
+
+#include <chrono>
+#if defined(__linux__)
+#include <time.h>
+#endif
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define UTPP_HAS_TSC 1
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#include <cpuid.h>
+#define UTPP_HAS_TSC 1
+#endif
+
+namespace UnitTest {
+
+/// Source of time values for timers
+class TimeSource
+{
+public:
+  /// Available time sources
+  enum kind {
+    steady,                 ///< `std::chrono::steady_clock`
+    monotonic_raw,          ///< `clock_gettime (CLOCK_MONOTONIC_RAW)` (Linux only)
+    tsc                     ///< Calibrated time stamp counter (x86 only)
+  };
+
+  static TimeSource& instance ();
+
+  bool select (kind k);
+
+  /// Return selected time source
+  kind source () const { return selected; }
+
+  /// Return cost (in nanoseconds) of reading the time
+  long long overhead () const { return cost; }
+
+  long long now () const;
+
+  static bool tsc_invariant ();
+  static bool has_rdtscp ();
+
+private:
+  TimeSource ();
+  TimeSource (const TimeSource&) = delete;
+  TimeSource& operator= (const TimeSource&) = delete;
+
+  void calibrate_tsc ();
+  void measure_overhead ();
+  static unsigned long long read_tsc ();
+
+  kind selected;
+  long long cost;
+  double ns_per_tick;
+  unsigned long long tsc_origin;
+};
+
+/// Select the best time source available
+inline
+TimeSource::TimeSource ()
+  : selected (steady)
+  , cost (0)
+  , ns_per_tick (0)
+  , tsc_origin (0)
+{
+  if (!select (tsc) && !select (monotonic_raw))
+    select (steady);
+}
+
+/// Return the time source used by all timers
+inline
+TimeSource& TimeSource::instance ()
+{
+  static TimeSource src;
+  return src;
+}
+
+/*!
+  Change the time source.
+  \param k  New time source
+  \return `true` if successful, `false` if the time source is not available
+*/
+inline
+bool TimeSource::select (kind k)
+{
+  switch (k)
+  {
+  case tsc:
+    if (!tsc_invariant () || !has_rdtscp ())
+      return false;
+    selected = tsc;
+    calibrate_tsc ();
+    break;
+
+  case monotonic_raw:
+#if defined(__linux__) && defined(CLOCK_MONOTONIC_RAW)
+    selected = monotonic_raw;
+    break;
+#else
+    return false;
+#endif
+
+  default:
+    selected = steady;
+    break;
+  }
+  measure_overhead ();
+  return true;
+}
+
+/*!
+  Return `true` if the processor has a time stamp counter that runs at a
+  constant rate regardless of power states.
+*/
+inline
+bool TimeSource::tsc_invariant ()
+{
+#if defined(UTPP_HAS_TSC) && defined(_MSC_VER)
+  int regs[4];
+  __cpuid (regs, 0x80000000);
+  if ((unsigned)regs[0] < 0x80000007)
+    return false;
+  __cpuid (regs, 0x80000007);
+  return (regs[3] & (1 << 8)) != 0;
+#elif defined(UTPP_HAS_TSC)
+  unsigned eax = 0, ebx = 0, ecx = 0, edx = 0;
+  if (!__get_cpuid (0x80000007, &eax, &ebx, &ecx, &edx))
+    return false;
+  return (edx & (1 << 8)) != 0;
+#else
+  return false;
+#endif
+}
+
+/*!
+  Return `true` if the processor supports the RDTSCP instruction.
+
+  Virtual machines can hide this instruction even if the time stamp counter
+  is invariant.
+*/
+inline
+bool TimeSource::has_rdtscp ()
+{
+#if defined(UTPP_HAS_TSC) && defined(_MSC_VER)
+  int regs[4];
+  __cpuid (regs, 0x80000000);
+  if ((unsigned)regs[0] < 0x80000001)
+    return false;
+  __cpuid (regs, 0x80000001);
+  return (regs[3] & (1 << 27)) != 0;
+#elif defined(UTPP_HAS_TSC)
+  unsigned eax = 0, ebx = 0, ecx = 0, edx = 0;
+  if (!__get_cpuid (0x80000001, &eax, &ebx, &ecx, &edx))
+    return false;
+  return (edx & (1 << 27)) != 0;
+#else
+  return false;
+#endif
+}
+
+/*!
+  Read the time stamp counter after all previous instructions have executed.
+  Used only if has_rdtscp() returns `true`.
+*/
+inline
+unsigned long long TimeSource::read_tsc ()
+{
+#if defined(UTPP_HAS_TSC)
+  unsigned aux;
+  return __rdtscp (&aux);
+#else
+  return 0;
+#endif
+}
+
+/// Find TSC frequency by comparing it with the steady clock over a few milliseconds
+inline
+void TimeSource::calibrate_tsc ()
+{
+  using namespace std::chrono;
+  auto t0 = steady_clock::now ();
+  auto c0 = read_tsc ();
+  steady_clock::time_point t1;
+  do {
+    t1 = steady_clock::now ();
+  } while (t1 - t0 < milliseconds (10));
+  auto c1 = read_tsc ();
+
+  ns_per_tick = (double)duration_cast<nanoseconds>(t1 - t0).count () / (c1 - c0);
+  tsc_origin = c0;
+}
+
+/// Measure the minimum time between two consecutive readings of the time
+inline
+void TimeSource::measure_overhead ()
+{
+  cost = 0;
+  long long best = -1;
+  for (int i = 0; i < 1000; ++i)
+  {
+    auto t0 = now ();
+    auto t1 = now ();
+    if (best < 0 || t1 - t0 < best)
+      best = t1 - t0;
+  }
+  cost = best > 0 ? best : 0;
+}
+
+/// Return current time in nanoseconds from an arbitrary origin
+inline
+long long TimeSource::now () const
+{
+  switch (selected)
+  {
+#if defined(UTPP_HAS_TSC)
+  case tsc:
+    return (long long)((read_tsc () - tsc_origin) * ns_per_tick);
+#endif
+
+#if defined(__linux__) && defined(CLOCK_MONOTONIC_RAW)
+  case monotonic_raw:
+  {
+    timespec ts;
+    clock_gettime (CLOCK_MONOTONIC_RAW, &ts);
+    return (long long)ts.tv_sec * 1000000000 + ts.tv_nsec;
+  }
+#endif
+
+  default:
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now ().time_since_epoch ()).count ();
+  }
+}
+
+} //namespace UnitTest
@@ -0,0 +1,226 @@
+#pragma once
+/*
+  UTPP - A New Generation of UnitTest++
+  (c) Mircea Neacsu 2017-2025
+
+  See LICENSE file for full copyright information.
+*/
+
+/*!
+  \file environment.h
+  \brief Benchmark environment: CPU pinning, priority and system description
+
+  Benchmark results depend on the machine and its state. Before running the
+  first benchmark, UTPP records the CPU model, frequency governor, SMT state
+  and load average. Reporters include this information with benchmark
+  results.
+
+  To reduce noise, benchmarks can run pinned to one CPU and with a higher
+  scheduling priority (see `UnitTest::benchmark_cpu` and
+  `UnitTest::benchmark_high_priority`). These settings are available only on
+  Linux.
+*/
+
+#include <string>
+#include <ostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#if defined(__linux__)
+#include <sched.h>
+#include <sys/resource.h>
+#endif
+
+namespace UnitTest {
+
+/// Description of the system running benchmarks
+struct BenchmarkEnvironment
+{
+  std::string cpu_model;    ///< Processor model name
+  int cpus;                 ///< Number of logical CPUs
+  double mhz;               ///< Current CPU frequency (0 if unknown)
+  std::string governor;     ///< CPU frequency governor (empty if unknown)
+  int smt;                  ///< 1 if SMT is active, 0 if not, -1 if unknown
+  double load_avg[3];       ///< 1, 5 and 15 minutes load averages (negative if unknown)
+  int pinned_cpu;           ///< CPU benchmarks are pinned to or -1
+};
+
+/// Read the first line of a file. Returns an empty string if file cannot be read.
+inline
+std::string read_first_line (const char* filename)
+{
+  std::string line;
+  FILE* f = fopen (filename, "r");
+  if (f)
+  {
+    char buf[256];
+    if (fgets (buf, sizeof (buf), f))
+    {
+      line = buf;
+      while (!line.empty () && (line.back () == '\n' || line.back () == '\r'))
+        line.pop_back ();
+    }
+    fclose (f);
+  }
+  return line;
+}
+
+/*!
+  Collect information about the system.
+  \param cpu  CPU whose frequency and governor are reported
+*/
+inline
+BenchmarkEnvironment capture_environment (int cpu = 0)
+{
+  BenchmarkEnvironment env{};
+  env.cpus = (int)std::thread::hardware_concurrency ();
+  env.smt = -1;
+  env.load_avg[0] = env.load_avg[1] = env.load_avg[2] = -1;
+  env.pinned_cpu = -1;
+
+#if defined(__linux__)
+  FILE* f = fopen ("/proc/cpuinfo", "r");
+  if (f)
+  {
+    char line[256];
+    while (fgets (line, sizeof (line), f))
+    {
+      char* colon = strchr (line, ':');
+      if (!colon)
+        continue;
+      if (env.cpu_model.empty () && !strncmp (line, "model name", 10))
+      {
+        env.cpu_model = colon + 2;
+        if (!env.cpu_model.empty () && env.cpu_model.back () == '\n')
+          env.cpu_model.pop_back ();
+      }
+      else if (env.mhz == 0 && !strncmp (line, "cpu MHz", 7))
+        env.mhz = atof (colon + 1);
+    }
+    fclose (f);
+  }
+
+  char path[128];
+  snprintf (path, sizeof (path), "/sys/devices/system/cpu/cpu%d/cpufreq/scaling_cur_freq", cpu);
+  auto freq = read_first_line (path);
+  if (!freq.empty ())
+    env.mhz = atof (freq.c_str ()) / 1000.;
+  snprintf (path, sizeof (path), "/sys/devices/system/cpu/cpu%d/cpufreq/scaling_governor", cpu);
+  env.governor = read_first_line (path);
+
+  auto smt = read_first_line ("/sys/devices/system/cpu/smt/active");
+  if (!smt.empty ())
+    env.smt = atoi (smt.c_str ());
+#else
+  (void)cpu;
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+  double la[3];
+  if (getloadavg (la, 3) == 3)
+  {
+    for (int i = 0; i < 3; ++i)
+      env.load_avg[i] = la[i];
+  }
+#endif
+  return env;
+}
+
+/// Output a one line description of benchmark environment
+inline
+void write_environment (std::ostream& os, const BenchmarkEnvironment& env)
+{
+  auto flags = os.flags (std::ios::dec | std::ios::fixed);
+  auto prec = os.precision (2);
+  os << "CPU: " << (env.cpu_model.empty () ? "unknown" : env.cpu_model)
+    << " (" << env.cpus << " CPUs";
+  if (env.smt >= 0)
+    os << ", SMT " << (env.smt ? "on" : "off");
+  if (env.mhz > 0)
+    os << ", " << env.mhz << " MHz";
+  if (!env.governor.empty ())
+    os << ", governor " << env.governor;
+  os << ')';
+  if (env.pinned_cpu >= 0)
+    os << ", pinned to CPU " << env.pinned_cpu;
+  if (env.load_avg[0] >= 0)
+  {
+    os << ", load average " << env.load_avg[0] << ' ' << env.load_avg[1]
+      << ' ' << env.load_avg[2];
+  }
+  os.flags (flags);
+  os.precision (prec);
+}
+
+/*!
+  Pins the calling thread to a CPU and raises its scheduling priority for
+  the lifetime of the object.
+
+  Previous settings are restored by the destructor. If a setting cannot be
+  changed (for instance, raising priority usually requires elevated
+  privileges), it is silently left unchanged.
+*/
+class BenchmarkIsolation
+{
+public:
+  BenchmarkIsolation (int cpu, bool high_priority);
+  ~BenchmarkIsolation ();
+
+private:
+  BenchmarkIsolation (const BenchmarkIsolation&) = delete;
+  BenchmarkIsolation& operator= (const BenchmarkIsolation&) = delete;
+
+#if defined(__linux__)
+  bool pinned;
+  cpu_set_t old_mask;
+  bool reniced;
+  int old_nice;
+#endif
+};
+
+/*!
+  Apply new settings.
+  \param cpu            CPU to pin the thread to or -1 to leave affinity unchanged
+  \param high_priority  If `true`, the thread priority is raised
+*/
+inline
+BenchmarkIsolation::BenchmarkIsolation (int cpu, bool high_priority)
+#if defined(__linux__)
+  : pinned (false)
+  , reniced (false)
+  , old_nice (0)
+{
+  if (cpu >= 0 && cpu < CPU_SETSIZE && sched_getaffinity (0, sizeof (old_mask), &old_mask) == 0)
+  {
+    cpu_set_t mask;
+    CPU_ZERO (&mask);
+    CPU_SET (cpu, &mask);
+    pinned = (sched_setaffinity (0, sizeof (mask), &mask) == 0);
+  }
+  if (high_priority)
+  {
+    old_nice = getpriority (PRIO_PROCESS, 0);
+    reniced = (setpriority (PRIO_PROCESS, 0, -20) == 0);
+  }
+}
+#else
+{
+  (void)cpu;
+  (void)high_priority;
+}
+#endif
+
+/// Restore previous settings
+inline
+BenchmarkIsolation::~BenchmarkIsolation ()
+{
+#if defined(__linux__)
+  if (pinned)
+    sched_setaffinity (0, sizeof (old_mask), &old_mask);
+  if (reniced)
+    setpriority (PRIO_PROCESS, 0, old_nice);
+#endif
+}
+
+} //namespace UnitTest
@@ -0,0 +1,311 @@
+#pragma once
+/*
+  UTPP - A New Generation of UnitTest++
+  (c) Mircea Neacsu 2017-2025
+
+  See LICENSE file for full copyright information.
+*/
+
+/*!
+  \file escape.h
+  \brief Escaping of special characters in reports
+
+  Strings are scanned for special characters 16 or 32 bytes at a time using
+  SSE2 or AVX2 instructions, if available. Runs of ordinary characters are
+  copied without further processing.
+*/
+
+#include <string>
+#include <ostream>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define UTPP_ESCAPE_AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define UTPP_ESCAPE_SSE2 1
+#endif
+
+namespace UnitTest {
+
+/// Return `true` if `c` is a control character or one of the characters `C...`
+template <char C>
+inline
+bool is_special (char c)
+{
+  return c == C || (unsigned char)c < 0x20;
+}
+
+template <char C1, char C2, char... Rest>
+inline
+bool is_special (char c)
+{
+  return c == C1 || is_special<C2, Rest...> (c);
+}
+
+#if defined(UTPP_ESCAPE_AVX2)
+/// Mask of bytes that are control characters or one of the characters `C...`
+template <char C>
+inline
+__m256i special_mask (__m256i x)
+{
+  //unsigned x <= 0x1f if min (x, 0x1f) == x
+  __m256i ctl = _mm256_cmpeq_epi8 (_mm256_min_epu8 (x, _mm256_set1_epi8 (0x1f)), x);
+  return _mm256_or_si256 (ctl, _mm256_cmpeq_epi8 (x, _mm256_set1_epi8 (C)));
+}
+
+template <char C1, char C2, char... Rest>
+inline
+__m256i special_mask (__m256i x)
+{
+  return _mm256_or_si256 (_mm256_cmpeq_epi8 (x, _mm256_set1_epi8 (C1)),
+    special_mask<C2, Rest...> (x));
+}
+#elif defined(UTPP_ESCAPE_SSE2)
+/// Mask of bytes that are control characters or one of the characters `C...`
+template <char C>
+inline
+__m128i special_mask (__m128i x)
+{
+  //unsigned x <= 0x1f if min (x, 0x1f) == x
+  __m128i ctl = _mm_cmpeq_epi8 (_mm_min_epu8 (x, _mm_set1_epi8 (0x1f)), x);
+  return _mm_or_si128 (ctl, _mm_cmpeq_epi8 (x, _mm_set1_epi8 (C)));
+}
+
+template <char C1, char C2, char... Rest>
+inline
+__m128i special_mask (__m128i x)
+{
+  return _mm_or_si128 (_mm_cmpeq_epi8 (x, _mm_set1_epi8 (C1)),
+    special_mask<C2, Rest...> (x));
+}
+#endif
+
+/// Return index of lowest set bit of a non-zero value
+inline
+int lowest_bit (unsigned m)
+{
+#if defined(__GNUC__) || defined(__clang__)
+  return __builtin_ctz (m);
+#else
+  int i = 0;
+  while (!(m & 1))
+  {
+    m >>= 1;
+    ++i;
+  }
+  return i;
+#endif
+}
+
+/*!
+  Find the first special character in a string.
+  \param s          Characters to scan
+  \param n          Number of characters
+  \param non_ascii  If `true`, characters above 0x7F are also special
+  \return Index of first special character or `n` if there is none.
+
+  Special characters are control characters and the characters `C...`.
+*/
+template <char... C>
+inline
+size_t find_special (const char* s, size_t n, bool non_ascii = false)
+{
+  size_t i = 0;
+#if defined(UTPP_ESCAPE_AVX2)
+  for (; i + 32 <= n; i += 32)
+  {
+    __m256i x = _mm256_loadu_si256 ((const __m256i*)(s + i));
+    unsigned m = (unsigned)_mm256_movemask_epi8 (special_mask<C...> (x));
+    if (non_ascii)
+      m |= (unsigned)_mm256_movemask_epi8 (x);
+    if (m)
+      return i + lowest_bit (m);
+  }
+#elif defined(UTPP_ESCAPE_SSE2)
+  for (; i + 16 <= n; i += 16)
+  {
+    __m128i x = _mm_loadu_si128 ((const __m128i*)(s + i));
+    unsigned m = (unsigned)_mm_movemask_epi8 (special_mask<C...> (x));
+    if (non_ascii)
+      m |= (unsigned)_mm_movemask_epi8 (x);
+    if (m)
+      return i + lowest_bit (m);
+  }
+#endif
+  for (; i < n; ++i)
+  {
+    if (is_special<C...> (s[i]) || (non_ascii && (unsigned char)s[i] > 0x7f))
+      return i;
+  }
+  return n;
+}
+
+/*!
+  Return length of the UTF-8 sequence at the beginning of a string or 0 if
+  it is not a valid sequence. Overlong encodings and surrogates are not valid.
+*/
+inline
+size_t utf8_length (const char* s, size_t n)
+{
+  auto c = (unsigned char)s[0];
+  size_t len;
+  unsigned char lo = 0x80, hi = 0xbf;   //range of second byte
+  if (c < 0x80)
+    return 1;
+  else if (c < 0xc2)
+    return 0;
+  else if (c < 0xe0)
+    len = 2;
+  else if (c < 0xf0)
+  {
+    len = 3;
+    if (c == 0xe0)
+      lo = 0xa0;
+    else if (c == 0xed)
+      hi = 0x9f;
+  }
+  else if (c < 0xf5)
+  {
+    len = 4;
+    if (c == 0xf0)
+      lo = 0x90;
+    else if (c == 0xf4)
+      hi = 0x8f;
+  }
+  else
+    return 0;
+
+  if (n < len)
+    return 0;
+  auto c1 = (unsigned char)s[1];
+  if (c1 < lo || c1 > hi)
+    return 0;
+  for (size_t i = 2; i < len; ++i)
+  {
+    if (((unsigned char)s[i] & 0xc0) != 0x80)
+      return 0;
+  }
+  return len;
+}
+
+/// A string to be written with XML escapes. See xml_escape().
+struct XmlEscaped
+{
+  const char* str;          ///< Characters to write
+  size_t len;               ///< Number of characters
+};
+
+/*!
+  Return a string wrapper that writes the string to an output stream with
+  XML special characters escaped:
+  ```
+  os << "<name>" << xml_escape (name) << "</name>";
+  ```
+  Tab, newline and carriage return are written as character references so
+  that they are preserved in attribute values. Other control characters,
+  bytes that are not part of a valid UTF-8 sequence and the noncharacters
+  U+FFFE and U+FFFF are not allowed in an XML document encoded as UTF-8 and
+  are replaced by U+FFFD.
+
+  The wrapper keeps a pointer to the string; it must be used before the
+  string is destroyed.
+*/
+inline
+XmlEscaped xml_escape (const std::string& value)
+{
+  return XmlEscaped{ value.data (), value.size () };
+}
+
+/// Write a string with XML special characters escaped
+inline
+std::ostream& operator << (std::ostream& os, const XmlEscaped& x)
+{
+  size_t start = 0;
+  while (start < x.len)
+  {
+    size_t pos = start + find_special<'&', '<', '>', '\'', '\"'> (x.str + start, x.len - start, true);
+    os.write (x.str + start, pos - start);
+    if (pos == x.len)
+      break;
+    auto c = (unsigned char)x.str[pos];
+    if (c > 0x7f)
+    {
+      size_t n = utf8_length (x.str + pos, x.len - pos);
+      if (n == 3 && c == 0xef && (unsigned char)x.str[pos + 1] == 0xbf
+       && (unsigned char)x.str[pos + 2] >= 0xbe)
+        n = 0; //U+FFFE or U+FFFF
+      if (n)
+        os.write (x.str + pos, n);
+      else
+        os << "&#xFFFD;";
+      start = pos + (n ? n : 1);
+      continue;
+    }
+    switch (c)
+    {
+    case '&':  os << "&amp;"; break;
+    case '<':  os << "&lt;"; break;
+    case '>':  os << "&gt;"; break;
+    case '\'': os << "&apos;"; break;
+    case '\"': os << "&quot;"; break;
+    case '\t': os << "&#9;"; break;
+    case '\n': os << "&#10;"; break;
+    case '\r': os << "&#13;"; break;
+    default:   os << "&#xFFFD;"; break;
+    }
+    start = pos + 1;
+  }
+  return os;
+}
+
+/*!
+  Append a string to a buffer as the contents of a JSON string.
+
+  Quotes, backslashes and control characters are escaped. Bytes that are not
+  part of a valid UTF-8 sequence are replaced by U+FFFD so that the result
+  is accepted by validating JSON parsers.
+*/
+inline
+void json_escape (std::string& buf, const char* str, size_t len)
+{
+  static const char hex[] = "0123456789abcdef";
+  size_t start = 0;
+  while (start < len)
+  {
+    size_t pos = start + find_special<'\"', '\\'> (str + start, len - start, true);
+    buf.append (str + start, pos - start);
+    if (pos == len)
+      break;
+    auto c = (unsigned char)str[pos];
+    if (c > 0x7f)
+    {
+      size_t n = utf8_length (str + pos, len - pos);
+      if (n)
+        buf.append (str + pos, n);
+      else
+        buf.append ("\\ufffd");
+      start = pos + (n ? n : 1);
+      continue;
+    }
+    switch (c)
+    {
+    case '\"':  buf.append ("\\\""); break;
+    case '\\':  buf.append ("\\\\"); break;
+    case '\b':  buf.append ("\\b"); break;
+    case '\f':  buf.append ("\\f"); break;
+    case '\n':  buf.append ("\\n"); break;
+    case '\r':  buf.append ("\\r"); break;
+    case '\t':  buf.append ("\\t"); break;
+    default:
+      buf.append ("\\u00");
+      buf.push_back (hex[c >> 4]);
+      buf.push_back (hex[c & 0xf]);
+      break;
+    }
+    start = pos + 1;
+  }
+}
+
+} //namespace UnitTest
@@ -0,0 +1,161 @@
+#pragma once
+/*
+  UTPP - A New Generation of UnitTest++
+  (c) Mircea Neacsu 2017-2025
+
+  See LICENSE file for full copyright information.
+*/
+
+/*!
+  \file histogram.h
+  \brief Definition of UnitTest::LatencyHistogram class
+
+  The histogram uses log-linear buckets, similar to HdrHistogram: values
+  below 128 ns are recorded exactly; larger values are grouped in 64 buckets
+  for each power of two, giving a relative error below 1.6%. Memory use is
+  fixed, regardless of the number of recorded values.
+*/
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <ostream>
+
+namespace UnitTest {
+
+/// Histogram of operation latencies in nanoseconds
+class LatencyHistogram
+{
+public:
+  LatencyHistogram ();
+
+  void Record (long long ns, size_t count = 1);
+  void Clear ();
+
+  /// Return number of recorded values
+  size_t count () const { return total; }
+
+  /// Return largest recorded value
+  long long max () const { return largest; }
+
+  long long percentile (double p) const;
+
+  static size_t bucket (long long ns);
+  static long long bucket_limit (size_t idx);
+
+private:
+  static const int SUB_BITS = 7;      ///< values below 2^SUB_BITS are exact
+  static const int MAX_BIT = 40;      ///< larger values go in the last bucket
+  static const size_t BUCKETS = (1 << SUB_BITS) + (MAX_BIT - SUB_BITS + 1) * (1 << (SUB_BITS - 1));
+
+  std::vector<size_t> counts;
+  size_t total;
+  long long largest;
+};
+
+/// Constructor. Allocates all buckets.
+inline
+LatencyHistogram::LatencyHistogram ()
+  : counts (BUCKETS, 0)
+  , total (0)
+  , largest (0)
+{
+}
+
+/// Return index of bucket for a value
+inline
+size_t LatencyHistogram::bucket (long long ns)
+{
+  if (ns < (1 << SUB_BITS))
+    return ns > 0 ? (size_t)ns : 0;
+
+  unsigned long long v = (unsigned long long)ns;
+  if (v >> (MAX_BIT + 1))
+    v = (1ull << (MAX_BIT + 1)) - 1;
+
+  //position of most significant bit
+  int msb = 0;
+  for (int step = 32; step; step /= 2)
+  {
+    if (v >> (msb + step))
+      msb += step;
+  }
+  int shift = msb - (SUB_BITS - 1);
+  return (1 << SUB_BITS) + (size_t)(msb - SUB_BITS) * (1 << (SUB_BITS - 1))
+    + (size_t)((v >> shift) - (1 << (SUB_BITS - 1)));
+}
+
+/// Return largest value that goes in a bucket
+inline
+long long LatencyHistogram::bucket_limit (size_t idx)
+{
+  if (idx < (1 << SUB_BITS))
+    return (long long)idx;
+
+  size_t k = idx - (1 << SUB_BITS);
+  int msb = SUB_BITS + (int)(k >> (SUB_BITS - 1));
+  unsigned long long sub = (1 << (SUB_BITS - 1)) + (k & ((1 << (SUB_BITS - 1)) - 1));
+  int shift = msb - (SUB_BITS - 1);
+  return (long long)(((sub + 1) << shift) - 1);
+}
+
+/*!
+  Add a value to the histogram
+  \param ns     Value (in nanoseconds)
+  \param count  Number of occurrences
+*/
+inline
+void LatencyHistogram::Record (long long ns, size_t count)
+{
+  counts[bucket (ns)] += count;
+  total += count;
+  if (ns > largest)
+    largest = ns;
+}
+
+/// Remove all values
+inline
+void LatencyHistogram::Clear ()
+{
+  std::fill (counts.begin (), counts.end (), 0);
+  total = 0;
+  largest = 0;
+}
+
+/*!
+  Return value below which are `p` percent of the recorded values.
+
+  The result is the upper limit of the bucket containing the percentile, but
+  not more than the largest recorded value.
+*/
+inline
+long long LatencyHistogram::percentile (double p) const
+{
+  if (!total)
+    return 0;
+  size_t target = (size_t)ceil (p / 100. * total);
+  if (target < 1)
+    target = 1;
+  size_t sum = 0;
+  for (size_t i = 0; i < counts.size (); ++i)
+  {
+    sum += counts[i];
+    if (sum >= target)
+    {
+      auto v = bucket_limit (i);
+      return v < largest ? v : largest;
+    }
+  }
+  return largest;
+}
+
+/// Output percentiles of a latency distribution
+inline
+void write_latency (std::ostream& os, const LatencyStats& lat)
+{
+  os << "p50 " << lat.p50 << " ns, p90 " << lat.p90 << " ns, p99 " << lat.p99
+    << " ns, p99.9 " << lat.p999 << " ns, max " << lat.max << " ns ("
+    << lat.samples << " operations)";
+}
+
+} //namespace UnitTest
@@ -0,0 +1,347 @@
+#pragma once
+/*
+  UTPP - A New Generation of UnitTest++
+  (c) Mircea Neacsu 2017-2025
+
+  See LICENSE file for full copyright information.
+*/
+
+/*!
+  \file perf.h
+  \brief Hardware and software performance counters of tests
+
+  Performance counters are optional and available only on Linux. To enable
+  them, set the `UnitTest::track_perf_counters` flag before running the tests:
+  ```
+  UnitTest::track_perf_counters = true;
+  UnitTest::RunAllTests ();
+  ```
+  Counters are opened with `perf_event_open` system call the first time they
+  are needed and count only the events of the thread that opened them.
+  Hardware counters (cycles, instructions, cache and branch events) are
+  frequently not available in virtual machines or containers. In this case
+  only software counters (task clock and page faults) are reported. If no
+  counter can be opened, nothing is reported.
+*/
+
+#include <array>
+#include <ostream>
+#include <cstring>
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define UTPP_PERF_EVENTS 1
+#endif
+
+namespace UnitTest {
+
+/// Values of performance counters
+struct PerfCounters
+{
+  long long cycles;           ///< CPU cycles
+  long long instructions;     ///< Instructions retired
+  long long cache_refs;       ///< Last level cache references
+  long long cache_misses;     ///< Last level cache misses
+  long long branches;         ///< Branch instructions
+  long long branch_misses;    ///< Mispredicted branches
+  long long task_clock;       ///< CPU time (nanoseconds)
+  long long page_faults;      ///< Page faults
+};
+
+/// Description of a performance counter
+struct PerfEvent
+{
+  const char* name;                 ///< Name used in XML reports
+  unsigned type;                    ///< `perf_event_attr` type
+  unsigned long long config;        ///< `perf_event_attr` config
+  long long PerfCounters::*value;   ///< Counter in PerfCounters structure
+};
+
+#if UTPP_CPP_LANG < 201703L
+/// If `true`, performance counters of each test are measured
+extern bool track_perf_counters;
+#else
+/// If `true`, performance counters of each test are measured
+inline bool track_perf_counters = false;
+#endif
+
+/// Number of counters in PerfCounters structure
+const size_t PERF_EVENTS = 8;
+
+/*!
+  Return the list of performance counters.
+
+  Hardware counters are at the beginning of the list.
+*/
+inline
+const std::array<PerfEvent, PERF_EVENTS>& perf_events ()
+{
+#if defined(UTPP_PERF_EVENTS)
+  static const std::array<PerfEvent, PERF_EVENTS> events{ {
+    { "cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, &PerfCounters::cycles },
+    { "instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, &PerfCounters::instructions },
+    { "cache-references", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_REFERENCES, &PerfCounters::cache_refs },
+    { "cache-misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES, &PerfCounters::cache_misses },
+    { "branches", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_INSTRUCTIONS, &PerfCounters::branches },
+    { "branch-misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES, &PerfCounters::branch_misses },
+    { "task-clock-ns", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK, &PerfCounters::task_clock },
+    { "page-faults", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS, &PerfCounters::page_faults }
+  } };
+#else
+  static const std::array<PerfEvent, PERF_EVENTS> events{ {
+    { "cycles", 0, 0, &PerfCounters::cycles },
+    { "instructions", 0, 0, &PerfCounters::instructions },
+    { "cache-references", 0, 0, &PerfCounters::cache_refs },
+    { "cache-misses", 0, 0, &PerfCounters::cache_misses },
+    { "branches", 0, 0, &PerfCounters::branches },
+    { "branch-misses", 0, 0, &PerfCounters::branch_misses },
+    { "task-clock-ns", 0, 0, &PerfCounters::task_clock },
+    { "page-faults", 0, 0, &PerfCounters::page_faults }
+  } };
+#endif
+  return events;
+}
+
+/*!
+  File descriptors of opened performance counters.
+
+  Hardware counters are opened as a group so that they are scheduled
+  together on the PMU. Software counters are opened individually.
+*/
+class PerfCounterSet
+{
+public:
+  static PerfCounterSet& instance ();
+
+  /// Return `true` if counter `i` could be opened
+  bool available (size_t i) const { return fd[i] >= 0; }
+
+  /// Return `true` if any counter could be opened
+  bool any () const;
+
+  PerfCounters read () const;
+
+private:
+  PerfCounterSet ();
+  ~PerfCounterSet ();
+  PerfCounterSet (const PerfCounterSet&) = delete;
+  PerfCounterSet& operator= (const PerfCounterSet&) = delete;
+
+  std::array<int, PERF_EVENTS> fd;
+};
+
+/// Open performance counters
+inline
+PerfCounterSet::PerfCounterSet ()
+{
+  fd.fill (-1);
+#if defined(UTPP_PERF_EVENTS)
+  int leader = -1;
+  for (size_t i = 0; i < PERF_EVENTS; ++i)
+  {
+    auto& ev = perf_events ()[i];
+    bool hw = (ev.type == PERF_TYPE_HARDWARE);
+    if (hw && i > 0 && leader < 0)
+      continue; //group leader could not be opened
+
+    perf_event_attr attr;
+    memset (&attr, 0, sizeof (attr));
+    attr.size = sizeof (attr);
+    attr.type = ev.type;
+    attr.config = ev.config;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    fd[i] = (int)syscall (SYS_perf_event_open, &attr, 0, -1, hw ? leader : -1, 0);
+    if (hw && i == 0)
+      leader = fd[i];
+  }
+#endif
+}
+
+/// Close performance counters
+inline
+PerfCounterSet::~PerfCounterSet ()
+{
+#if defined(UTPP_PERF_EVENTS)
+  for (auto f : fd)
+  {
+    if (f >= 0)
+      close (f);
+  }
+#endif
+}
+
+/// Return the set of performance counters of the program
+inline
+PerfCounterSet& PerfCounterSet::instance ()
+{
+  static PerfCounterSet counters;
+  return counters;
+}
+
+inline
+bool PerfCounterSet::any () const
+{
+  for (auto f : fd)
+  {
+    if (f >= 0)
+      return true;
+  }
+  return false;
+}
+
+/*!
+  Return current values of performance counters.
+
+  If counters have been multiplexed, their values are scaled by the fraction
+  of time they have been running. Counters that are not available are 0.
+*/
+inline
+PerfCounters PerfCounterSet::read () const
+{
+  PerfCounters pc{};
+#if defined(UTPP_PERF_EVENTS)
+  for (size_t i = 0; i < PERF_EVENTS; ++i)
+  {
+    if (fd[i] < 0)
+      continue;
+    unsigned long long data[3]; //value, time enabled, time running
+    if (::read (fd[i], data, sizeof (data)) != (ssize_t)sizeof (data) || !data[2])
+      continue;
+    double val = (double)data[0];
+    if (data[2] < data[1])
+      val *= (double)data[1] / data[2];
+    pc.*perf_events ()[i].value = (long long)val;
+  }
+#endif
+  return pc;
+}
+
+/// Return `true` if a performance counter is measured
+inline
+bool perf_event_available (size_t i)
+{
+  return track_perf_counters && PerfCounterSet::instance ().available (i);
+}
+
+/// Return `true` if any performance counter is measured
+inline
+bool perf_tracking ()
+{
+  return track_perf_counters && PerfCounterSet::instance ().any ();
+}
+
+/// Add the difference between two readings of performance counters to a total
+inline
+void perf_accumulate (PerfCounters& total, const PerfCounters& start, const PerfCounters& end)
+{
+  for (auto& ev : perf_events ())
+    total.*ev.value += end.*ev.value - start.*ev.value;
+}
+
+///@{
+/// Ratios derived from performance counters. They are 0 if not available.
+inline double perf_ipc (const PerfCounters& pc)
+{ return pc.cycles ? (double)pc.instructions / pc.cycles : 0.; }
+
+inline double perf_cache_miss_rate (const PerfCounters& pc)
+{ return pc.cache_refs ? (double)pc.cache_misses / pc.cache_refs : 0.; }
+
+inline double perf_branch_miss_rate (const PerfCounters& pc)
+{ return pc.branches ? (double)pc.branch_misses / pc.branches : 0.; }
+///@}
+
+/*!
+  Output a short description of performance counters.
+  \param os         Output stream
+  \param pc         Counter values
+  \param iterations If not 0, counters are shown per iteration
+
+  Only available counters are shown.
+*/
+inline
+void write_perf_counters (std::ostream& os, const PerfCounters& pc, double iterations = 0)
+{
+  auto flags = os.flags (std::ios::dec | std::ios::fixed);
+  auto prec = os.precision (2);
+  const char* sep = "";
+  if (perf_event_available (0))
+  {
+    if (iterations > 0)
+      os << sep << "cycles " << pc.cycles / iterations << "/iteration";
+    else
+      os << sep << "cycles " << pc.cycles;
+    sep = ", ";
+  }
+  if (perf_event_available (0) && perf_event_available (1))
+    os << sep << "IPC " << perf_ipc (pc);
+  if (perf_event_available (2) && perf_event_available (3))
+  {
+    os << sep << "cache misses " << perf_cache_miss_rate (pc) * 100 << '%';
+    sep = ", ";
+  }
+  if (perf_event_available (4) && perf_event_available (5))
+  {
+    os << sep << "branch misses " << perf_branch_miss_rate (pc) * 100 << '%';
+    sep = ", ";
+  }
+  if (perf_event_available (6))
+  {
+    if (iterations > 0)
+      os << sep << "task clock " << pc.task_clock / iterations << " ns/iteration";
+    else
+      os << sep << "task clock " << pc.task_clock / 1e6 << " ms";
+    sep = ", ";
+  }
+  if (perf_event_available (7))
+  {
+    if (iterations > 0)
+      os << sep << "page faults " << pc.page_faults / iterations << "/iteration";
+    else
+      os << sep << "page faults " << pc.page_faults;
+  }
+  os.flags (flags);
+  os.precision (prec);
+}
+
+/*!
+  Measures performance counters between the creation of the object and a
+  call to counters() function.
+
+  If `track_perf_counters` flag is not set, the meter does nothing and all
+  counters are 0.
+*/
+class PerfMeter
+{
+public:
+  PerfMeter ();
+  PerfCounters counters () const;
+
+private:
+  bool active;
+  PerfCounters start;
+};
+
+/// Take a snapshot of performance counters
+inline
+PerfMeter::PerfMeter ()
+  : active (track_perf_counters)
+  , start ()
+{
+  if (active)
+    start = PerfCounterSet::instance ().read ();
+}
+
+/// Return counter values since the meter was created
+inline
+PerfCounters PerfMeter::counters () const
+{
+  PerfCounters pc{};
+  if (active)
+    perf_accumulate (pc, start, PerfCounterSet::instance ().read ());
+  return pc;
+}
+
+} //namespace UnitTest
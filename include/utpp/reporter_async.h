@@ -0,0 +1,493 @@
+#pragma once
+/*
+  UTPP - A New Generation of UnitTest++
+  (c) Mircea Neacsu 2017-2025
+
+  See LICENSE file for full copyright information.
+*/
+
+/*!
+  \file reporter_async.h
+  \brief Definition of UnitTest::AsyncReporter class
+*/
+
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+
+namespace UnitTest
+{
+
+/*!
+  Bounded multiple-producer, single-consumer queue.
+
+  Each slot has a sequence number that tells if it is free or full, as in
+  Dmitry Vyukov's bounded MPMC queue. Producers claim a slot with a
+  compare-and-swap on the write position and fill it in place; slots are
+  reused, so their contents keep any memory they have allocated.
+*/
+template <class T>
+class MpscRing
+{
+public:
+  explicit MpscRing (size_t capacity);
+
+  template <class F>
+  bool TryPush (F&& fill);
+
+  template <class F>
+  bool TryPop (F&& use);
+
+  bool empty () const;
+
+  /// Return number of slots claimed by producers since construction
+  size_t pushed () const { return write_pos.load (std::memory_order_acquire); }
+
+private:
+  struct Slot
+  {
+    std::atomic<size_t> seq;
+    T value;
+  };
+
+  size_t mask;
+  std::unique_ptr<Slot[]> slots;
+  alignas(64) std::atomic<size_t> write_pos;
+  alignas(64) size_t read_pos;
+};
+
+/// Constructor. Capacity is rounded up to a power of 2.
+template <class T>
+MpscRing<T>::MpscRing (size_t capacity)
+  : write_pos (0)
+  , read_pos (0)
+{
+  size_t n = 2;
+  while (n < capacity)
+    n *= 2;
+  mask = n - 1;
+  slots.reset (new Slot[n]);
+  for (size_t i = 0; i < n; ++i)
+    slots[i].seq.store (i, std::memory_order_relaxed);
+}
+
+/*!
+  Add an element to the queue. Can be called from any thread.
+  \param fill Function called as `fill (T&)` to fill in a free slot
+  \return `false` if the queue is full
+*/
+template <class T>
+template <class F>
+bool MpscRing<T>::TryPush (F&& fill)
+{
+  size_t pos = write_pos.load (std::memory_order_relaxed);
+  Slot* slot;
+  for (;;)
+  {
+    slot = &slots[pos & mask];
+    size_t seq = slot->seq.load (std::memory_order_acquire);
+    auto diff = (std::ptrdiff_t)seq - (std::ptrdiff_t)pos;
+    if (diff == 0)
+    {
+      if (write_pos.compare_exchange_weak (pos, pos + 1, std::memory_order_relaxed))
+        break;
+    }
+    else if (diff < 0)
+      return false;
+    else
+      pos = write_pos.load (std::memory_order_relaxed);
+  }
+  fill (slot->value);
+  slot->seq.store (pos + 1, std::memory_order_release);
+  return true;
+}
+
+/*!
+  Remove the oldest element from the queue. Must be called only from the
+  consumer thread.
+  \param use Function called as `use (T&)` with the element
+  \return `false` if the queue is empty
+*/
+template <class T>
+template <class F>
+bool MpscRing<T>::TryPop (F&& use)
+{
+  Slot& slot = slots[read_pos & mask];
+  if (slot.seq.load (std::memory_order_acquire) != read_pos + 1)
+    return false;
+  use (slot.value);
+  slot.seq.store (read_pos + mask + 1, std::memory_order_release);
+  ++read_pos;
+  return true;
+}
+
+/// Return `true` if the oldest element is not ready. Consumer thread only.
+template <class T>
+bool MpscRing<T>::empty () const
+{
+  return slots[read_pos & mask].seq.load (std::memory_order_acquire) != read_pos + 1;
+}
+
+/*!
+  A Reporter that forwards events to another reporter on a background thread.
+
+  Tests are not slowed down by a slow output stream: events are copied to a
+  bounded lock-free queue and a background thread delivers them to the
+  wrapped reporter. Events are reported by the thread running the tests;
+  failures of the worker threads of multithreaded benchmarks are reported by
+  it after the workers finish.
+  ```
+  std::ofstream os ("results.xml");
+  UnitTest::ReporterXmlStreaming xml (os);
+  UnitTest::AsyncReporter async (xml);
+  UnitTest::RunAllTests (async);
+  ```
+  When the queue is full, the test thread waits for the background thread
+  or, if the reporter was created with the `drop` policy, failure messages,
+  benchmark results and complexity fits are discarded. Suite and test start
+  and finish events are never discarded.
+
+  Summary() waits until all events have been delivered and calls the wrapped
+  reporter's Summary() on the calling thread, so the report is complete when
+  RunAllTests() returns.
+
+  The wrapped reporter must find the suite and test of an event using
+  reported_suite() and reported_test(), not CurrentSuite and CurrentTest.
+*/
+class AsyncReporter : public Reporter
+{
+public:
+  /// What to do when the queue is full
+  enum overflow {
+    block,                  ///< Wait for the background thread
+    drop                    ///< Discard failures and benchmark results
+  };
+
+  explicit AsyncReporter (Reporter& wrapped, size_t capacity = 1024, overflow policy = block);
+  ~AsyncReporter ();
+
+  void SuiteStart (const TestSuite& suite) override;
+  void TestStart (const Test& test) override;
+  void ReportFailure (const Failure& failure) override;
+  void ReportBenchmark (const BenchmarkStats& stats) override;
+  void ReportComplexity (const ComplexityFit& fit) override;
+  void TestFinish (const Test& test) override;
+  int SuiteFinish (const TestSuite& suite) override;
+  int Summary () override;
+  void Clear () override;
+
+  void Flush ();
+
+  /// Return number of events discarded because the queue was full
+  size_t dropped () const { return drop_count.load (std::memory_order_relaxed); }
+
+private:
+  AsyncReporter (const AsyncReporter&) = delete;
+  AsyncReporter& operator= (const AsyncReporter&) = delete;
+
+  /// Copy of a reporter call
+  struct Event
+  {
+    enum kind { suite_start, test_start, failure, benchmark, complexity,
+      test_finish, suite_finish };
+    kind type;
+    Symbol suite;             ///< Current suite when event was pushed
+    Symbol test;              ///< Current test or empty if outside a test
+    int failures;             ///< Failures of test
+    std::chrono::nanoseconds time;  ///< Run time of test
+    AllocStats allocs;        ///< Heap allocations of test
+    ResourceUsage rusage;     ///< OS resources used by test
+    PerfCounters perf;        ///< Performance counters of test
+    Failure fail;             ///< Failure message
+    BenchmarkStats stats;     ///< Benchmark results
+    ComplexityFit fit;        ///< Complexity fit
+  };
+
+  template <class F>
+  void Push (bool essential, F&& fill);
+  void Wake ();
+  void Drain ();
+  void Deliver (Event& ev);
+
+  Reporter& wrapped;
+  overflow policy;
+  MpscRing<Event> queue;
+  std::atomic<size_t> delivered;    ///< Number of events delivered
+  std::atomic<size_t> drop_count;
+  std::atomic<bool> waiting;        ///< Background thread is waiting for events
+  std::atomic<bool> stop;
+  std::mutex mtx;
+  std::condition_variable cv;
+
+  Test test_proxy;                  ///< %Test passed to wrapped reporter
+  TestSuite suite_proxy;            ///< Suite passed to wrapped reporter
+  std::thread worker;
+};
+
+/*!
+  Constructor.
+  \param rep      Reporter that receives the events
+  \param capacity Maximum number of events waiting to be delivered
+  \param pol      What to do when the queue is full
+*/
+inline
+AsyncReporter::AsyncReporter (Reporter& rep, size_t capacity, overflow pol)
+  : wrapped (rep)
+  , policy (pol)
+  , queue (capacity)
+  , delivered (0)
+  , drop_count (0)
+  , waiting (false)
+  , stop (false)
+  , test_proxy (Symbol ())
+  , suite_proxy (Symbol ())
+{
+  worker = std::thread (&AsyncReporter::Drain, this);
+}
+
+/// Destructor. Delivers all pending events and stops background thread.
+inline
+AsyncReporter::~AsyncReporter ()
+{
+  stop.store (true);
+  {
+    std::lock_guard<std::mutex> lock (mtx);
+    cv.notify_one ();
+  }
+  worker.join ();
+}
+
+/*!
+  Add an event to the queue.
+  \param essential  If `false`, event can be dropped when the queue is full
+  \param fill       Function that fills in an Event structure
+
+  Memory allocated while copying the event is not counted as allocated by
+  the test.
+*/
+template <class F>
+void AsyncReporter::Push (bool essential, F&& fill)
+{
+  AllocPause pause;
+  Symbol suite = CurrentSuite;
+  Symbol test = CurrentTest ? CurrentTest->test_symbol () : Symbol ();
+  auto fill_all = [&](Event& ev) {
+    ev.suite = suite;
+    ev.test = test;
+    fill (ev);
+  };
+  while (!queue.TryPush (fill_all))
+  {
+    if (!essential && policy == drop)
+    {
+      drop_count.fetch_add (1, std::memory_order_relaxed);
+      return;
+    }
+    Wake ();
+    std::this_thread::yield ();
+  }
+  Wake ();
+}
+
+/// Wake up background thread if it is waiting for events
+inline
+void AsyncReporter::Wake ()
+{
+  std::atomic_thread_fence (std::memory_order_seq_cst);
+  if (waiting.load (std::memory_order_relaxed))
+  {
+    std::lock_guard<std::mutex> lock (mtx);
+    cv.notify_one ();
+  }
+}
+
+/*!
+  Background thread function. Delivers events until the reporter is
+  destroyed.
+
+  When the queue is empty the thread sleeps. Producers wake it up, but it
+  also checks the queue every millisecond in case a wake-up was missed.
+*/
+inline
+void AsyncReporter::Drain ()
+{
+  auto& ctx = report_context ();
+  for (;;)
+  {
+    if (queue.TryPop ([this](Event& ev) { Deliver (ev); }))
+    {
+      delivered.fetch_add (1, std::memory_order_release);
+      continue;
+    }
+    if (stop.load ())
+      break;
+
+    std::unique_lock<std::mutex> lock (mtx);
+    waiting.store (true, std::memory_order_relaxed);
+    std::atomic_thread_fence (std::memory_order_seq_cst);
+    if (queue.empty () && !stop.load ())
+      cv.wait_for (lock, std::chrono::milliseconds (1));
+    waiting.store (false, std::memory_order_relaxed);
+  }
+  ctx.suite = nullptr;
+  ctx.test = nullptr;
+}
+
+/// Call wrapped reporter with an event, on the background thread
+inline
+void AsyncReporter::Deliver (Event& ev)
+{
+  auto& ctx = report_context ();
+  ctx.suite = &ev.suite;
+  ctx.test = ev.test.empty () ? nullptr : &test_proxy;
+  test_proxy.name = ev.test;
+  suite_proxy.name = ev.suite;
+
+  switch (ev.type)
+  {
+  case Event::suite_start:
+    wrapped.SuiteStart (suite_proxy);
+    break;
+
+  case Event::test_start:
+  case Event::test_finish:
+    test_proxy.failures = ev.failures;
+    test_proxy.time = ev.time;
+    test_proxy.allocs = ev.allocs;
+    test_proxy.rusage = ev.rusage;
+    test_proxy.perf = ev.perf;
+    if (ev.type == Event::test_start)
+      wrapped.TestStart (test_proxy);
+    else
+      wrapped.TestFinish (test_proxy);
+    break;
+
+  case Event::failure:
+    wrapped.ReportFailure (ev.fail);
+    break;
+
+  case Event::benchmark:
+    wrapped.ReportBenchmark (ev.stats);
+    break;
+
+  case Event::complexity:
+    wrapped.ReportComplexity (ev.fit);
+    break;
+
+  case Event::suite_finish:
+    wrapped.SuiteFinish (suite_proxy);
+    break;
+  }
+}
+
+/*!
+  Wait until all events have been delivered to the wrapped reporter.
+
+  Must not be called while other threads are reporting events.
+*/
+inline
+void AsyncReporter::Flush ()
+{
+  size_t target = queue.pushed ();
+  while (delivered.load (std::memory_order_acquire) < target)
+  {
+    Wake ();
+    std::this_thread::yield ();
+  }
+}
+
+inline
+void AsyncReporter::SuiteStart (const TestSuite& suite)
+{
+  Reporter::SuiteStart (suite);
+  Push (true, [](Event& ev) { ev.type = Event::suite_start; });
+}
+
+inline
+void AsyncReporter::TestStart (const Test& test)
+{
+  Reporter::TestStart (test);
+  Push (true, [&test](Event& ev) {
+    ev.type = Event::test_start;
+    ev.failures = test.failure_count ();
+    ev.time = test.test_time ();
+    ev.allocs = test.alloc_stats ();
+    ev.rusage = test.resource_usage ();
+    ev.perf = test.perf_counters ();
+  });
+}
+
+inline
+void AsyncReporter::ReportFailure (const Failure& failure)
+{
+  Reporter::ReportFailure (failure);
+  Push (false, [&failure](Event& ev) {
+    ev.type = Event::failure;
+    ev.fail.filename = failure.filename;
+    ev.fail.message.assign (failure.message);
+    ev.fail.line_number = failure.line_number;
+  });
+}
+
+inline
+void AsyncReporter::ReportBenchmark (const BenchmarkStats& stats)
+{
+  Reporter::ReportBenchmark (stats);
+  Push (false, [&stats](Event& ev) {
+    ev.type = Event::benchmark;
+    ev.stats = stats;
+  });
+}
+
+inline
+void AsyncReporter::ReportComplexity (const ComplexityFit& fit)
+{
+  Reporter::ReportComplexity (fit);
+  Push (false, [&fit](Event& ev) {
+    ev.type = Event::complexity;
+    ev.fit = fit;
+  });
+}
+
+inline
+void AsyncReporter::TestFinish (const Test& test)
+{
+  Reporter::TestFinish (test);
+  Push (true, [&test](Event& ev) {
+    ev.type = Event::test_finish;
+    ev.failures = test.failure_count ();
+    ev.time = test.test_time ();
+    ev.allocs = test.alloc_stats ();
+    ev.rusage = test.resource_usage ();
+    ev.perf = test.perf_counters ();
+  });
+}
+
+/// Queue suite finish event. Returns number of failures counted by this reporter.
+inline
+int AsyncReporter::SuiteFinish (const TestSuite& suite)
+{
+  Push (true, [](Event& ev) { ev.type = Event::suite_finish; });
+  return Reporter::SuiteFinish (suite);
+}
+
+/// Deliver all pending events and generate report of wrapped reporter
+inline
+int AsyncReporter::Summary ()
+{
+  Flush ();
+  return wrapped.Summary ();
+}
+
+/// Deliver all pending events and reset wrapped reporter
+inline
+void AsyncReporter::Clear ()
+{
+  Flush ();
+  wrapped.Clear ();
+  Reporter::Clear ();
+}
+
+}
@@ -43,6 +43,9 @@ namespace UnitTest {
 /// A Reporter that sends messages to debug output
 class ReporterDbgout : public Reporter
 {
+public:
+  ReporterDbgout ();
+
 protected:
   void SuiteStart (const TestSuite& suite) override;
   void TestStart (const Test& test) override;
@@ -50,7 +53,11 @@ protected:
   int SuiteFinish (const TestSuite& suite) override;
 
   void ReportFailure (const Failure& failure) override;
+  void ReportBenchmark (const BenchmarkStats& stats) override;
+  void ReportComplexity (const ComplexityFit& fit) override;
   int Summary () override;
+  void Clear () override;
+
 private:
 #ifdef _UNICODE
   std::wstring widen (const std::string& s);
@@ -62,8 +69,25 @@ private:
     OutputDebugString (ss.str ().c_str());
   }
 #endif
+
+  bool env_shown;           ///< `true` if benchmark environment has been shown
 };
 
+/// Constructor
+inline
+ReporterDbgout::ReporterDbgout ()
+  : env_shown (false)
+{
+}
+
+/// Reset all statistics
+inline
+void ReporterDbgout::Clear ()
+{
+  Reporter::Clear ();
+  env_shown = false;
+}
+
 
 /// If tracing is enabled, show a suite start message 
 inline
@@ -97,7 +121,20 @@ void ReporterDbgout::TestFinish (const Test& test)
   if (trace)
   {
     std::stringstream ss;
-    ss << "Test finished: " << test.test_name () << std::endl;
+    ss << "Test finished: " << test.test_name ();
+    if (alloc_tracking_installed ())
+    {
+      auto& a = test.alloc_stats ();
+      ss << " (" << a.count << " allocations, " << a.bytes << " bytes, peak "
+        << a.peak << " bytes, leaked " << a.leaked << " bytes)";
+    }
+    if (perf_tracking ())
+    {
+      ss << " [";
+      write_perf_counters (ss, test.perf_counters ());
+      ss << ']';
+    }
+    ss << std::endl;
     ODS (ss);
   }
   Reporter::TestFinish (test);
@@ -128,11 +165,11 @@ void ReporterDbgout::ReportFailure (const Failure& failure)
 {
   std::stringstream ss;
   ss << "Failure in ";
-  if (CurrentTest)
+  if (reported_test ())
   {
-    if (CurrentSuite != DEFAULT_SUITE)
-      ss << "suite " << CurrentSuite << ' ';
-    ss << "test " << CurrentTest->test_name ();
+    if (reported_suite () != DEFAULT_SUITE)
+      ss << "suite " << reported_suite () << ' ';
+    ss << "test " << reported_test ()->test_name ();
   }
   ss << std::endl;
   ODS (ss);
@@ -145,6 +182,41 @@ void ReporterDbgout::ReportFailure (const Failure& failure)
   Reporter::ReportFailure (failure);
 }
 
+/// Output benchmark results to debug output
+inline
+void ReporterDbgout::ReportBenchmark (const BenchmarkStats& stats)
+{
+  std::stringstream ss;
+  if (!env_shown)
+  {
+    write_environment (ss, benchmark_environment ());
+    ss << std::endl;
+    env_shown = true;
+  }
+  ss << "Benchmark ";
+  if (reported_suite () != DEFAULT_SUITE)
+    ss << reported_suite () << "::";
+  ss << reported_test ()->test_name ();
+  write_benchmark (ss, stats);
+  ODS (ss);
+  Reporter::ReportBenchmark (stats);
+}
+
+/// Output complexity fit of a parameterized benchmark to debug output
+inline
+void ReporterDbgout::ReportComplexity (const ComplexityFit& fit)
+{
+  std::stringstream ss;
+  ss << "Complexity ";
+  if (reported_suite () != DEFAULT_SUITE)
+    ss << reported_suite () << "::";
+  ss << reported_test ()->test_name () << ": ";
+  write_complexity (ss, fit);
+  ss << std::endl;
+  ODS (ss);
+  Reporter::ReportComplexity (fit);
+}
+
 /*!
   Prints a test run summary including number of tests, number of failures,
   running time, etc.
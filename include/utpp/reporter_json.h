@@ -0,0 +1,369 @@
+#pragma once
+/*
+  UTPP - A New Generation of UnitTest++
+  (c) Mircea Neacsu 2017-2025
+
+  See LICENSE file for full copyright information.
+*/
+
+/*!
+  \file reporter_json.h
+  \brief Definition of UnitTest::ReporterJson class
+*/
+
+#include <iostream>
+#include <string>
+#include <cstdio>
+#include <cmath>
+
+namespace UnitTest
+{
+
+/*!
+  A Reporter that writes one JSON object for each event, in JSON Lines
+  (newline delimited JSON) format:
+  ```
+  {"event":"suite-start","suite":"EarthSuite"}
+  {"event":"test-start","suite":"EarthSuite","test":"earth_radius"}
+  {"event":"failure","suite":"EarthSuite","test":"earth_radius","file":"sample.cpp","line":121,"message":"..."}
+  {"event":"test-finish","suite":"EarthSuite","test":"earth_radius","time-ns":1050,"failures":1}
+  {"event":"suite-finish","suite":"EarthSuite","tests":3,"failed":1,"failures":1,"time-ns":5230}
+  {"event":"summary","tests":21,"failed":11,"failures":11,"time-ns":12031000000}
+  ```
+  Benchmark results and complexity fits are reported as "benchmark" and
+  "complexity" events. Member names are the same as the attribute names in
+  XML reports.
+
+  Each line is built in a reusable buffer and written to the output stream
+  with a single call. The stream is flushed after failures, at the end of
+  each suite and after the summary, so that the report can be followed while
+  tests are running.
+*/
+class ReporterJson : public Reporter
+{
+public:
+  explicit ReporterJson (std::ostream& ostream = std::cout);
+
+  void SuiteStart (const TestSuite& suite) override;
+  void TestStart (const Test& test) override;
+  void ReportFailure (const Failure& failure) override;
+  void ReportBenchmark (const BenchmarkStats& stats) override;
+  void ReportComplexity (const ComplexityFit& fit) override;
+  void TestFinish (const Test& test) override;
+  int SuiteFinish (const TestSuite& suite) override;
+  int Summary () override;
+
+protected:
+  void Begin (const char* event);
+  void Key (const char* name);
+  void Number (long long value);
+  void Add (const char* name, const std::string& value);
+  void Add (const char* name, const char* value);
+  void Add (const char* name, long long value);
+  void Add (const char* name, double value);
+  void AddTestName ();
+  void AddPerfCounters (const PerfCounters& pc, double iterations = 0);
+  void End (bool flush = false);
+
+  std::ostream& os;
+  std::string line;         ///< Buffer for current line
+
+private:
+  ReporterJson (const ReporterJson&) = delete;
+  ReporterJson& operator= (const ReporterJson&) = delete;
+};
+
+/*!
+  Constructor.
+
+  \param ostream Output stream that will contain JSON formatted results
+*/
+inline
+ReporterJson::ReporterJson (std::ostream& ostream)
+  : os (ostream)
+{
+  line.reserve (256);
+}
+
+/// Start a new event object
+inline
+void ReporterJson::Begin (const char* event)
+{
+  line.clear ();
+  line.append ("{\"event\":\"");
+  line.append (event);
+  line.push_back ('\"');
+}
+
+/// Add name of next member
+inline
+void ReporterJson::Key (const char* name)
+{
+  line.append (",\"");
+  line.append (name);
+  line.append ("\":");
+}
+
+/// Append an integer value
+inline
+void ReporterJson::Number (long long value)
+{
+  char buf[24];
+  char* p = buf + sizeof (buf);
+  unsigned long long v = value < 0 ? 0ull - (unsigned long long)value : (unsigned long long)value;
+  do {
+    *--p = (char)('0' + v % 10);
+    v /= 10;
+  } while (v);
+  if (value < 0)
+    *--p = '-';
+  line.append (p, buf + sizeof (buf) - p);
+}
+
+/// Add a string member
+inline
+void ReporterJson::Add (const char* name, const std::string& value)
+{
+  Key (name);
+  line.push_back ('\"');
+  json_escape (line, value.data (), value.size ());
+  line.push_back ('\"');
+}
+
+/// Add a string member
+inline
+void ReporterJson::Add (const char* name, const char* value)
+{
+  Key (name);
+  line.push_back ('\"');
+  json_escape (line, value, strlen (value));
+  line.push_back ('\"');
+}
+
+/// Add an integer member
+inline
+void ReporterJson::Add (const char* name, long long value)
+{
+  Key (name);
+  Number (value);
+}
+
+/*!
+  Add a floating point member.
+
+  JSON has no representation for infinite and NaN values; they are written
+  as `null`.
+*/
+inline
+void ReporterJson::Add (const char* name, double value)
+{
+  Key (name);
+  if (!std::isfinite (value))
+  {
+    line.append ("null");
+    return;
+  }
+  char buf[32];
+  int n = snprintf (buf, sizeof (buf), "%.10g", value);
+  for (int i = 0; i < n; ++i)
+  {
+    if (buf[i] == ',') //C locale set to use a decimal comma
+      buf[i] = '.';
+  }
+  line.append (buf, n);
+}
+
+/// Add suite and test names of current test
+inline
+void ReporterJson::AddTestName ()
+{
+  Add ("suite", reported_suite ().str ());
+  if (reported_test ())
+    Add ("test", reported_test ()->test_name ());
+}
+
+/*!
+  Add available performance counters.
+  \param pc          Counter values
+  \param iterations  If not 0, counters are divided by this number
+*/
+inline
+void ReporterJson::AddPerfCounters (const PerfCounters& pc, double iterations)
+{
+  for (size_t i = 0; i < PERF_EVENTS; ++i)
+  {
+    if (perf_event_available (i))
+    {
+      auto& ev = perf_events ()[i];
+      if (iterations > 0)
+        Add (ev.name, pc.*ev.value / iterations);
+      else
+        Add (ev.name, pc.*ev.value);
+    }
+  }
+}
+
+/// Finish current event object and write it to output stream
+inline
+void ReporterJson::End (bool flush)
+{
+  line.append ("}\n");
+  os.write (line.data (), line.size ());
+  if (flush)
+    os.flush ();
+}
+
+inline
+void ReporterJson::SuiteStart (const TestSuite& suite)
+{
+  Reporter::SuiteStart (suite);
+  Begin ("suite-start");
+  Add ("suite", suite.name.str ());
+  End ();
+}
+
+inline
+void ReporterJson::TestStart (const Test& test)
+{
+  Reporter::TestStart (test);
+  Begin ("test-start");
+  Add ("suite", reported_suite ().str ());
+  Add ("test", test.test_name ());
+  End ();
+}
+
+inline
+void ReporterJson::ReportFailure (const Failure& failure)
+{
+  Begin ("failure");
+  AddTestName ();
+  Add ("file", failure.filename.str ());
+  Add ("line", (long long)failure.line_number);
+  Add ("message", failure.message);
+  End (true);
+  Reporter::ReportFailure (failure);
+}
+
+inline
+void ReporterJson::ReportBenchmark (const BenchmarkStats& stats)
+{
+  Begin ("benchmark");
+  AddTestName ();
+  if (!stats.args.empty ())
+  {
+    Key ("args");
+    line.push_back ('[');
+    for (size_t i = 0; i < stats.args.size (); ++i)
+    {
+      if (i)
+        line.push_back (',');
+      Number ((long long)stats.args[i]);
+    }
+    line.push_back (']');
+  }
+  Add ("iterations", (long long)stats.iterations);
+  Add ("repetitions", (long long)stats.repetitions);
+  Add ("mean-ns", stats.mean);
+  Add ("median-ns", stats.median);
+  Add ("stddev-ns", stats.stddev);
+  Add ("min-ns", stats.min);
+  if (stats.bytes_rate > 0)
+    Add ("bytes-per-second", stats.bytes_rate);
+  if (stats.items_rate > 0)
+    Add ("items-per-second", stats.items_rate);
+  if (stats.threads)
+  {
+    Add ("threads", (long long)stats.threads);
+    Add ("total-rate", stats.total_rate);
+    Add ("thread-rate", stats.thread_rate);
+    Add ("efficiency", stats.efficiency);
+  }
+  auto& cmp = stats.comparison;
+  if (cmp.verdict != vNoBaseline)
+  {
+    static const char* key[] = { "baseline-ns", "baseline-bytes-per-second",
+      "baseline-items-per-second" };
+    Add (key[cmp.metric], cmp.baseline);
+    Add ("delta", cmp.delta);
+    Add ("p-value", cmp.p_value);
+    Add ("verdict", verdict_name (cmp.verdict));
+  }
+  if (stats.latency.samples)
+  {
+    Add ("latency-samples", (long long)stats.latency.samples);
+    Add ("p50-ns", (long long)stats.latency.p50);
+    Add ("p90-ns", (long long)stats.latency.p90);
+    Add ("p99-ns", (long long)stats.latency.p99);
+    Add ("p999-ns", (long long)stats.latency.p999);
+    Add ("max-ns", (long long)stats.latency.max);
+  }
+  AddPerfCounters (stats.perf, (double)stats.iterations * stats.repetitions);
+  End ();
+  Reporter::ReportBenchmark (stats);
+}
+
+inline
+void ReporterJson::ReportComplexity (const ComplexityFit& fit)
+{
+  Begin ("complexity");
+  AddTestName ();
+  Add ("big-o", big_o_name (fit.big_o));
+  Add ("coefficient", fit.coefficient);
+  Add ("rms", fit.rms);
+  End ();
+  Reporter::ReportComplexity (fit);
+}
+
+/// Write test duration, number of failures and resources used by test
+inline
+void ReporterJson::TestFinish (const Test& test)
+{
+  Reporter::TestFinish (test);
+  Begin ("test-finish");
+  Add ("suite", reported_suite ().str ());
+  Add ("test", test.test_name ());
+  Add ("time-ns", (long long)test.test_time ().count ());
+  Add ("failures", (long long)test.failure_count ());
+  if (alloc_tracking_installed ())
+  {
+    auto& a = test.alloc_stats ();
+    Add ("allocations", (long long)a.count);
+    Add ("allocated-bytes", (long long)a.bytes);
+    Add ("peak-bytes", (long long)a.peak);
+    Add ("leaked-bytes", a.leaked);
+  }
+  if (track_resources)
+  {
+    for (auto& c : resource_counters ())
+      Add (c.name, test.resource_usage ().*c.value);
+  }
+  AddPerfCounters (test.perf_counters ());
+  End ();
+}
+
+inline
+int ReporterJson::SuiteFinish (const TestSuite& suite)
+{
+  Begin ("suite-finish");
+  Add ("suite", suite.name.str ());
+  Add ("tests", (long long)suite_test_count);
+  Add ("failed", (long long)suite_failed_count);
+  Add ("failures", (long long)suite_failures_count);
+  Add ("time-ns", (long long)suite_time.count ());
+  End (true);
+  return Reporter::SuiteFinish (suite);
+}
+
+inline
+int ReporterJson::Summary ()
+{
+  Begin ("summary");
+  Add ("tests", (long long)total_test_count);
+  Add ("failed", (long long)total_failed_count);
+  Add ("failures", (long long)total_failures_count);
+  Add ("time-ns", (long long)total_time.count ());
+  End (true);
+  return Reporter::Summary ();
+}
+
+}
@@ -0,0 +1,269 @@
+#pragma once
+/*
+  UTPP - A New Generation of UnitTest++
+  (c) Mircea Neacsu 2017-2025
+
+  See LICENSE file for full copyright information.
+*/
+
+/*!
+  \file reporter_junit.h
+  \brief Definition of UnitTest::ReporterJUnit class
+*/
+
+#include <sstream>
+
+namespace UnitTest
+{
+
+/*!
+  A Reporter that writes results in the JUnit XML format used by most
+  continuous integration servers:
+  ```
+  <testsuites tests="3" failures="1" errors="0" time="0.012">
+   <testsuite name="EarthSuite" tests="3" failures="1" errors="0" time="0.012">
+    <testcase name="earth_radius" classname="EarthSuite" time="0.000105">
+     <failure message="..." type="failure">...</failure>
+    </testcase>
+    ...
+   </testsuite>
+  </testsuites>
+  ```
+  Times are in seconds. Tests that are not in a suite are reported in a
+  suite called "DefaultSuite".
+
+  Each test is written when the next test starts or when the suite finishes,
+  so that failures reported while the test fixture is destroyed are included.
+  Only the results of the current test are kept in memory. Counts of a suite are not known when the
+  `<testsuite>` element is written. If the output stream is seekable,
+  space is reserved for them and it is filled by SuiteFinish(). Otherwise,
+  the test cases of the current suite are kept as text until the suite
+  finishes and the counts of the root element are omitted.
+*/
+class ReporterJUnit : public ReporterXml
+{
+public:
+  explicit ReporterJUnit (std::ostream& ostream = std::cout);
+
+  void SuiteStart (const TestSuite& suite) override;
+  void TestStart (const Test& test) override;
+  int SuiteFinish (const TestSuite& suite) override;
+  int Summary () override;
+  void Clear () override;
+
+private:
+  void WriteHeader ();
+  void WriteTest ();
+  void BeginSuite (std::ostream& out, const Symbol& name);
+  void EndSuite ();
+  void WriteCounts (std::ostream& out, int tests, int failed, std::chrono::nanoseconds time);
+  bool Patch (std::streampos pos, const std::string& attr);
+
+  /// Space reserved for counts in `<testsuites>` and `<testsuite>` elements
+  static const size_t COUNTS_WIDTH = 80;
+
+  bool header_written;        ///< `true` if root element has been written
+  bool suite_open;            ///< `true` if a suite element is open
+  Symbol suite_name;          ///< Name of current suite
+  std::streampos totals_pos;  ///< Position of totals or -1 if stream is not seekable
+  std::streampos counts_pos;  ///< Position of suite counts or -1
+  std::ostringstream suite_buf; ///< Test cases of current suite if stream is not seekable
+};
+
+/*!
+  Constructor.
+
+  \param ostream Output stream that will contain XML formatted results
+*/
+inline
+ReporterJUnit::ReporterJUnit (std::ostream& ostream)
+  : ReporterXml (ostream)
+  , header_written (false)
+  , suite_open (false)
+  , totals_pos (-1)
+  , counts_pos (-1)
+{
+  suite_buf << std::fixed << std::setprecision (6);
+}
+
+/// Write root element
+inline
+void ReporterJUnit::WriteHeader ()
+{
+  if (header_written)
+    return;
+  os.copyfmt (orig_state);
+  os << "<testsuites";
+  totals_pos = os.tellp ();
+  if (totals_pos != std::streampos (-1))
+    os << std::string (COUNTS_WIDTH, ' ');
+  os << ">\n";
+  os << std::fixed << std::setprecision (6);
+  header_written = true;
+}
+
+/// Write start of `<testsuite>` element, up to the counts attributes
+inline
+void ReporterJUnit::BeginSuite (std::ostream& out, const Symbol& name)
+{
+  out << " <testsuite name=\"" << xml_escape (name.str ()) << '\"';
+}
+
+/// Write counts attributes of a `<testsuites>` or `<testsuite>` element
+inline
+void ReporterJUnit::WriteCounts (std::ostream& out, int tests, int failed,
+                                 std::chrono::nanoseconds time)
+{
+  out << " tests=\"" << tests << '\"'
+    << " failures=\"" << failed << '\"'
+    << " errors=\"0\""
+    << " time=\"" << std::chrono::duration<double> (time).count () << '\"';
+}
+
+/*!
+  Overwrite reserved space at a given position in output stream.
+  \return `true` if successful
+*/
+inline
+bool ReporterJUnit::Patch (std::streampos pos, const std::string& attr)
+{
+  if (pos == std::streampos (-1) || attr.size () > COUNTS_WIDTH)
+    return false;
+
+  bool patched = false;
+  auto end = os.tellp ();
+  if (os.seekp (pos))
+  {
+    os << attr;
+    patched = (bool)os.seekp (end);
+  }
+  os.clear ();
+  return patched;
+}
+
+/// Start a new `<testsuite>` element
+inline
+void ReporterJUnit::SuiteStart (const TestSuite& suite)
+{
+  results.clear ();
+  ReporterXml::SuiteStart (suite);
+  WriteHeader ();
+  suite_name = suite.name;
+  suite_buf.str (std::string ());
+  counts_pos = -1;
+  if (totals_pos != std::streampos (-1))
+  {
+    BeginSuite (os, suite_name);
+    counts_pos = os.tellp ();
+    os << std::string (COUNTS_WIDTH, ' ') << ">\n";
+  }
+  suite_open = true;
+}
+
+/// Write previous test before starting a new one
+inline
+void ReporterJUnit::TestStart (const Test& test)
+{
+  WriteTest ();
+  ReporterXml::TestStart (test);
+}
+
+/// Write `<testcase>` element of last test, if not already written, and forget its results
+inline
+void ReporterJUnit::WriteTest ()
+{
+  if (results.empty () || results.back ().test_name.empty ())
+    return; //no test or only the suite record
+  auto& r = results.back ();
+  std::ostream& out = (counts_pos != std::streampos (-1)) ? os : suite_buf;
+
+  out << "  <testcase name=\"" << xml_escape (r.test_name.str ()) << '\"'
+    << " classname=\"" << xml_escape (r.suite_name.str ()) << '\"'
+    << " time=\"" << std::chrono::duration<double> (r.test_time).count () << '\"';
+  if (r.failures.empty ())
+    out << "/>\n";
+  else
+  {
+    // JUnit allows only one failure per test case. All failure messages go
+    // in the element text.
+    auto& first = r.failures.front ();
+    out << ">\n   <failure message=\"" << xml_escape (first.message) << "\" type=\"failure\">";
+    for (auto& fail : r.failures)
+    {
+      out << xml_escape (fail.filename.str ()) << '(' << fail.line_number << ") : "
+        << xml_escape (fail.message) << '\n';
+    }
+    out << "</failure>\n  </testcase>\n";
+  }
+  if (!r.failures.empty () && &out == &os)
+    os.flush ();
+  results.pop_back ();
+}
+
+/*!
+  Fill in counts of current suite and close `<testsuite>` element.
+
+  If no space was reserved for counts, the element is written now, followed
+  by the buffered test cases.
+*/
+inline
+void ReporterJUnit::EndSuite ()
+{
+  if (!suite_open)
+    return;
+
+  WriteTest ();
+  std::ostringstream counts;
+  counts << std::fixed << std::setprecision (6);
+  WriteCounts (counts, suite_test_count, suite_failed_count, suite_time);
+  if (counts_pos != std::streampos (-1))
+    Patch (counts_pos, counts.str ());
+  else
+  {
+    BeginSuite (os, suite_name);
+    os << counts.str () << ">\n" << suite_buf.str ();
+    suite_buf.str (std::string ());
+  }
+  os << " </testsuite>\n";
+  suite_open = false;
+}
+
+/// Close `<testsuite>` element and flush output stream
+inline
+int ReporterJUnit::SuiteFinish (const TestSuite& suite)
+{
+  EndSuite ();
+  os.flush ();
+  return ReporterXml::SuiteFinish (suite);
+}
+
+/// Finish XML report and write totals
+inline
+int ReporterJUnit::Summary ()
+{
+  WriteHeader ();
+  EndSuite ();
+
+  std::ostringstream totals;
+  totals << std::fixed << std::setprecision (6);
+  WriteCounts (totals, total_test_count, total_failed_count, total_time);
+  Patch (totals_pos, totals.str ());
+  os << "</testsuites>\n";
+  EraseTail ();
+  results.clear ();
+  return ReporterDeferred::Summary ();
+}
+
+/// Restart report
+inline
+void ReporterJUnit::Clear ()
+{
+  ReporterXml::Clear ();
+  header_written = false;
+  suite_open = false;
+  totals_pos = -1;
+  counts_pos = -1;
+  suite_buf.str (std::string ());
+}
+
+}
@@ -0,0 +1,168 @@
+#pragma once
+/*
+  UTPP - A New Generation of UnitTest++
+  (c) Mircea Neacsu 2017-2025
+
+  See LICENSE file for full copyright information.
+*/
+
+/*!
+  \file reporter_multi.h
+  \brief Definition of UnitTest::MultiReporter class
+*/
+
+#include <vector>
+#include <mutex>
+#include <initializer_list>
+
+namespace UnitTest
+{
+
+/*!
+  A Reporter that forwards all events to several other reporters.
+
+  It allows producing different report formats in a single run:
+  ```
+  std::ofstream os ("results.xml");
+  UnitTest::ReporterXml xml (os);
+  UnitTest::ReporterStream console;
+  UnitTest::MultiReporter both {&console, &xml};
+  UnitTest::RunAllTests (both);
+  ```
+  Each event is delivered to all reporters, in the order they were added,
+  before the next event is processed. Events are serialized, so all reporters
+  see them in the same order even if a user reports events from several
+  threads.
+
+  The counts of the multi-reporter itself are updated as in any other
+  reporter; SuiteFinish() and Summary() return its own counts.
+
+  To run the reporters on a background thread, wrap the multi-reporter in an
+  AsyncReporter. Each event is then copied only once, to the queue of the
+  AsyncReporter, and fanned out to all reporters by the background thread.
+*/
+class MultiReporter : public Reporter
+{
+public:
+  MultiReporter () {};
+  MultiReporter (std::initializer_list<Reporter*> reporters);
+
+  void Add (Reporter& rep);
+
+  void SuiteStart (const TestSuite& suite) override;
+  void TestStart (const Test& test) override;
+  void ReportFailure (const Failure& failure) override;
+  void ReportBenchmark (const BenchmarkStats& stats) override;
+  void ReportComplexity (const ComplexityFit& fit) override;
+  void TestFinish (const Test& test) override;
+  int SuiteFinish (const TestSuite& suite) override;
+  int Summary () override;
+  void Clear () override;
+
+private:
+  MultiReporter (const MultiReporter&) = delete;
+  MultiReporter& operator= (const MultiReporter&) = delete;
+
+  std::vector<Reporter*> children;  ///< Reporters that receive events
+  std::mutex mtx;                   ///< Serializes events
+};
+
+/// Constructor. Events are forwarded to all reporters in the list.
+inline
+MultiReporter::MultiReporter (std::initializer_list<Reporter*> reporters)
+  : children (reporters)
+{
+}
+
+/// Add a reporter. Must not be called while tests are running.
+inline
+void MultiReporter::Add (Reporter& rep)
+{
+  children.push_back (&rep);
+}
+
+inline
+void MultiReporter::SuiteStart (const TestSuite& suite)
+{
+  std::lock_guard<std::mutex> lock (mtx);
+  Reporter::SuiteStart (suite);
+  for (auto r : children)
+    r->SuiteStart (suite);
+}
+
+inline
+void MultiReporter::TestStart (const Test& test)
+{
+  std::lock_guard<std::mutex> lock (mtx);
+  Reporter::TestStart (test);
+  for (auto r : children)
+    r->TestStart (test);
+}
+
+inline
+void MultiReporter::ReportFailure (const Failure& failure)
+{
+  std::lock_guard<std::mutex> lock (mtx);
+  Reporter::ReportFailure (failure);
+  for (auto r : children)
+    r->ReportFailure (failure);
+}
+
+inline
+void MultiReporter::ReportBenchmark (const BenchmarkStats& stats)
+{
+  std::lock_guard<std::mutex> lock (mtx);
+  Reporter::ReportBenchmark (stats);
+  for (auto r : children)
+    r->ReportBenchmark (stats);
+}
+
+inline
+void MultiReporter::ReportComplexity (const ComplexityFit& fit)
+{
+  std::lock_guard<std::mutex> lock (mtx);
+  Reporter::ReportComplexity (fit);
+  for (auto r : children)
+    r->ReportComplexity (fit);
+}
+
+inline
+void MultiReporter::TestFinish (const Test& test)
+{
+  std::lock_guard<std::mutex> lock (mtx);
+  Reporter::TestFinish (test);
+  for (auto r : children)
+    r->TestFinish (test);
+}
+
+/// Forward suite finish event. Returns number of failures in suite.
+inline
+int MultiReporter::SuiteFinish (const TestSuite& suite)
+{
+  std::lock_guard<std::mutex> lock (mtx);
+  for (auto r : children)
+    r->SuiteFinish (suite);
+  return Reporter::SuiteFinish (suite);
+}
+
+/// Generate reports of all reporters. Returns number of failed tests.
+inline
+int MultiReporter::Summary ()
+{
+  std::lock_guard<std::mutex> lock (mtx);
+  for (auto r : children)
+    r->Summary ();
+  return Reporter::Summary ();
+}
+
+/// Reset statistics of all reporters
+inline
+void MultiReporter::Clear ()
+{
+  std::lock_guard<std::mutex> lock (mtx);
+  Reporter::Clear ();
+  for (auto r : children)
+    r->Clear ();
+}
+
+}
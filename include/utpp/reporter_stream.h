@@ -13,14 +13,38 @@
 
 #include <iostream>
 #include <iomanip>
+#include <array>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
 
 namespace UnitTest {
 
-/// A Reporter that sends results directly to an output stream
+/*!
+  A Reporter that sends results directly to an output stream.
+
+  By default the output stream is flushed after each message. In buffered
+  mode, messages are collected in a large buffer (see BlockBuffer) that is
+  flushed after failures, at suite boundaries and at the end of the run. A
+  background thread also flushes it when more than the flush interval has
+  passed since the last flush, so that the output of a test that hangs
+  reaches the output stream even if the program is killed. Use buffered mode
+  when tracing a large number of tests:
+  ```
+  UnitTest::ReporterStream rep (std::cout, 1024*1024);
+  rep.SetTrace (true);
+  UnitTest::RunAllTests (rep);
+  ```
+*/
 class ReporterStream : public Reporter
 {
 public:
-  ReporterStream (std::ostream& strm = std::cout);
+  ReporterStream (std::ostream& strm = std::cout, size_t buffer_size = 0);
+  ~ReporterStream ();
+
+  void Flush ();
+  void SetFlushInterval (std::chrono::milliseconds ms);
 
 protected:
   void SuiteStart (const TestSuite& suite) override;
@@ -29,20 +53,150 @@ protected:
   int SuiteFinish (const TestSuite& suite) override;
 
   void ReportFailure (const Failure& failure) override;
+  void ReportBenchmark (const BenchmarkStats& stats) override;
+  void ReportComplexity (const ComplexityFit& fit) override;
   int Summary () override;
+  void Clear () override;
+
+  void EndMessage (bool important = false);
+  std::unique_lock<std::mutex> Lock ();
+
+private:
+  ReporterStream (const ReporterStream&) = delete;
+  ReporterStream& operator= (const ReporterStream&) = delete;
+
+  void FlushOutput ();
+  void FlushPeriodically ();
+
+  std::unique_ptr<BlockBuffer> block;     ///< Output buffer in buffered mode
+  std::unique_ptr<std::ostream> buffered; ///< Stream writing to `block`
+  std::mutex out_lock;                    ///< Protects output buffer in buffered mode
+  std::condition_variable flush_cv;       ///< Wakes up flusher thread
+  bool stop_flusher;                      ///< Flusher thread must end
+  std::thread flusher;                    ///< Thread that flushes the buffer periodically
+
+protected:
+  std::ostream& out;                      ///< Output stream
+
+  /// %Test that used the most of a resource
+  struct Offender
+  {
+    long long value;                ///< resource usage
+    Symbol suite_name;              ///< suite name
+    Symbol test_name;               ///< test name
+  };
 
-  std::ostream& out;
+  /// Worst offenders for each of the resource counters
+  std::array<Offender, RESOURCE_COUNTERS> worst;
+
+  /// `true` if benchmark environment has been shown
+  bool env_shown;
+
+  std::chrono::milliseconds flush_interval;   ///< Maximum time between flushes
+  std::chrono::steady_clock::time_point last_flush; ///< Time of last flush
 };
 
 /*!
   Constructor for a stream reporter.
 
-  \param strm Output stream
+  \param strm        Output stream
+  \param buffer_size Size of output buffer or 0 for unbuffered mode
 */
 inline
-ReporterStream::ReporterStream (std::ostream& strm)
-  : out (strm)
+ReporterStream::ReporterStream (std::ostream& strm, size_t buffer_size)
+  : block (buffer_size ? new BlockBuffer (strm.rdbuf (), buffer_size) : nullptr)
+  , buffered (block ? new std::ostream (block.get ()) : nullptr)
+  , stop_flusher (false)
+  , out (buffered ? *buffered : strm)
+  , worst ()
+  , env_shown (false)
+  , flush_interval (100)
+  , last_flush (std::chrono::steady_clock::now ())
 {
+  if (block)
+    flusher = std::thread (&ReporterStream::FlushPeriodically, this);
+}
+
+/// Destructor. Stops the flusher thread and writes out remaining output.
+inline
+ReporterStream::~ReporterStream ()
+{
+  if (flusher.joinable ())
+  {
+    {
+      std::lock_guard<std::mutex> guard (out_lock);
+      stop_flusher = true;
+    }
+    flush_cv.notify_one ();
+    flusher.join ();
+  }
+}
+
+/// Write any buffered output to output stream and flush it
+inline
+void ReporterStream::Flush ()
+{
+  auto lock = Lock ();
+  FlushOutput ();
+}
+
+/// Set maximum time between flushes of output buffer
+inline
+void ReporterStream::SetFlushInterval (std::chrono::milliseconds ms)
+{
+  {
+    auto lock = Lock ();
+    flush_interval = ms;
+  }
+  flush_cv.notify_one ();
+}
+
+/*!
+  Lock output buffer while writing a message, so that the flusher thread
+  doesn't access it at the same time. In unbuffered mode nothing is locked.
+*/
+inline
+std::unique_lock<std::mutex> ReporterStream::Lock ()
+{
+  return block ? std::unique_lock<std::mutex> (out_lock) : std::unique_lock<std::mutex> ();
+}
+
+/// Flush output stream. In buffered mode the caller must hold the lock.
+inline
+void ReporterStream::FlushOutput ()
+{
+  out.flush ();
+  last_flush = std::chrono::steady_clock::now ();
+}
+
+/// Body of flusher thread: flush output buffer when the flush interval has elapsed
+inline
+void ReporterStream::FlushPeriodically ()
+{
+  std::unique_lock<std::mutex> lock (out_lock);
+  while (!stop_flusher)
+  {
+    auto due = last_flush + flush_interval;
+    if (std::chrono::steady_clock::now () >= due)
+      FlushOutput ();
+    else
+      flush_cv.wait_until (lock, due);
+  }
+}
+
+/*!
+  Called after writing a message, with the output buffer locked.
+  \param important  If `true`, output is flushed even in buffered mode
+
+  In unbuffered mode, output is always flushed. In buffered mode it is
+  flushed only if the message is important; other messages are flushed by
+  the flusher thread.
+*/
+inline
+void ReporterStream::EndMessage (bool important)
+{
+  if (!block || important)
+    FlushOutput ();
 }
 
 /// If tracing is enabled, show a suite start message
@@ -50,9 +204,10 @@ inline
 void ReporterStream::SuiteStart (const TestSuite& suite)
 {
   Reporter::SuiteStart (suite);
-  if (!trace)
-    return;
-  out << "Begin suite: " << suite.name << std::endl;
+  auto lock = Lock ();
+  if (trace)
+    out << "Begin suite: " << suite.name << '\n';
+  EndMessage (true);
 }
 
 /// If tracing is enabled, show a test start message
@@ -62,15 +217,47 @@ void ReporterStream::TestStart (const Test& test)
   Reporter::TestStart (test);
   if (!trace)
     return;
-  out << "Start test: " << test.test_name () << std::endl;
+  auto lock = Lock ();
+  out << "Start test: " << test.test_name () << '\n';
+  EndMessage ();
 }
 
-/// If tracing is enabled, show a test finish message
+/*!
+  If tracing is enabled, show a test finish message. If allocation tracking is
+  enabled, the message includes the allocations made by the test.
+*/
 inline
 void ReporterStream::TestFinish (const Test& test)
 {
   if (trace)
-    std::cout << "End test: " << test.test_name () << std::endl;
+  {
+    auto lock = Lock ();
+    out << "End test: " << test.test_name ();
+    if (alloc_tracking_installed ())
+    {
+      auto& a = test.alloc_stats ();
+      out << " (" << a.count << " allocations, " << a.bytes << " bytes, peak "
+        << a.peak << " bytes, leaked " << a.leaked << " bytes)";
+    }
+    if (perf_tracking ())
+    {
+      out << " [";
+      write_perf_counters (out, test.perf_counters ());
+      out << ']';
+    }
+    out << '\n';
+    EndMessage ();
+  }
+  if (track_resources)
+  {
+    auto& ru = test.resource_usage ();
+    for (size_t i = 0; i < worst.size (); i++)
+    {
+      auto val = ru.*resource_counters ()[i].value;
+      if (val > worst[i].value)
+        worst[i] = { val, reported_suite (), test.test_symbol () };
+    }
+  }
   Reporter::TestFinish (test);
 }
 
@@ -78,8 +265,12 @@ void ReporterStream::TestFinish (const Test& test)
 inline
 int ReporterStream::SuiteFinish (const TestSuite& suite)
 {
-  if (trace)
-    out << "End suite: " << suite.name << std::endl;
+  {
+    auto lock = Lock ();
+    if (trace)
+      out << "End suite: " << suite.name << '\n';
+    EndMessage (true);
+  }
   return Reporter::SuiteFinish (suite);
 }
 
@@ -93,26 +284,75 @@ int ReporterStream::SuiteFinish (const TestSuite& suite)
 inline
 void ReporterStream::ReportFailure (const Failure& failure)
 {
+  auto lock = Lock ();
   out << "Failure in ";
-  if (CurrentTest)
+  if (reported_test ())
   {
-    if (CurrentSuite != DEFAULT_SUITE)
-      out << "suite " << CurrentSuite << ' ';
-    out << "test " << CurrentTest->test_name ();
+    if (reported_suite () != DEFAULT_SUITE)
+      out << "suite " << reported_suite () << ' ';
+    out << "test " << reported_test ()->test_name ();
   }
   auto f = out.flags (std::ios::dec);
 
 #if defined(__APPLE__) || defined(__GNUG__)
-  out << std::endl << failure.filename << ":" << failure.line_number << ": error: "
-    << failure.message << std::endl;
+  out << '\n' << failure.filename << ":" << failure.line_number << ": error: "
+    << failure.message << '\n';
 #else
-  out << std::endl << failure.filename << "(" << failure.line_number << "): error: "
-    << failure.message << std::endl;
+  out << '\n' << failure.filename << "(" << failure.line_number << "): error: "
+    << failure.message << '\n';
 #endif
   out.flags (f);
+  EndMessage (true);
   Reporter::ReportFailure (failure);
 }
 
+/*!
+  Output benchmark results: time per iteration, number of iterations and,
+  if there is a baseline, the comparison with it.
+
+  Before the first benchmark, it shows the benchmark environment.
+
+  \param stats - benchmark statistics
+*/
+inline
+void ReporterStream::ReportBenchmark (const BenchmarkStats& stats)
+{
+  auto lock = Lock ();
+  if (!env_shown)
+  {
+    write_environment (out, benchmark_environment ());
+    out << '\n';
+    env_shown = true;
+  }
+  out << "Benchmark ";
+  if (reported_suite () != DEFAULT_SUITE)
+    out << reported_suite () << "::";
+  out << reported_test ()->test_name ();
+  write_benchmark (out, stats);
+  EndMessage ();
+  Reporter::ReportBenchmark (stats);
+}
+
+/*!
+  Output the complexity class that best fits the results of a parameterized
+  benchmark.
+
+  \param fit - complexity fit
+*/
+inline
+void ReporterStream::ReportComplexity (const ComplexityFit& fit)
+{
+  auto lock = Lock ();
+  out << "Complexity ";
+  if (reported_suite () != DEFAULT_SUITE)
+    out << reported_suite () << "::";
+  out << reported_test ()->test_name () << ": ";
+  write_complexity (out, fit);
+  out << '\n';
+  EndMessage ();
+  Reporter::ReportComplexity (fit);
+}
+
 /*!
   Prints a test run summary including number of tests, number of failures,
   running time, etc.
@@ -121,6 +361,7 @@ inline
 int ReporterStream::Summary ()
 {
   using namespace std::chrono;
+  auto lock = Lock ();
   auto f = out.flags (std::ios::dec | std::ios::fixed);
   auto p = out.precision (2);
 
@@ -128,18 +369,46 @@ int ReporterStream::Summary ()
   {
     out << "FAILURE: " << total_failed_count << " out of "
       << total_test_count << " tests failed (" << total_failures_count
-      << " failures)." << std::endl;
+      << " failures)." << '\n';
   }
   else
-    out << "Success: " << total_test_count << " tests passed." << std::endl;
+    out << "Success: " << total_test_count << " tests passed." << '\n';
 
   auto total_time_s = duration_cast<duration<float, std::chrono::seconds::period>>(total_time);
-  out << "Run time: " << total_time_s.count() << " seconds" << std::endl;
+  out << "Run time: " << total_time_s.count() << " seconds" << '\n';
+
+  if (track_resources)
+  {
+    out << "Worst offenders:" << '\n';
+    for (size_t i = 0; i < worst.size (); i++)
+    {
+      out << "  " << resource_counters ()[i].description << ": ";
+      if (worst[i].value > 0)
+      {
+        out << worst[i].value << " in ";
+        if (worst[i].suite_name != DEFAULT_SUITE)
+          out << worst[i].suite_name << "::";
+        out << worst[i].test_name << '\n';
+      }
+      else
+        out << "none" << '\n';
+    }
+  }
   out.flags (f);
   out.precision (p);
+  EndMessage (true);
   return Reporter::Summary ();
 }
 
+/// Reset all statistics including the worst offenders
+inline
+void ReporterStream::Clear ()
+{
+  Reporter::Clear ();
+  worst = {};
+  env_shown = false;
+}
+
 /*!
   This is only for compatibility with previous version.
   
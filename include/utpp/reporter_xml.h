@@ -55,47 +55,29 @@ public:
 
 protected:
   void BeginTest (const ReporterDeferred::TestResult& result);
+  void AddBenchmarks (const ReporterDeferred::TestResult& result);
   void AddFailure (const ReporterDeferred::TestResult& result);
+  void AddPerfCounters (const PerfCounters& pc, double iterations = 0);
+  void AddEnvironment ();
   void EndTest (const ReporterDeferred::TestResult& result);
+  void AddStartTime ();
+  void AddCommandLine ();
+  void AddEndTime ();
+  std::string totals ();
+  void EraseTail ();
 
-private:
-  std::string xml_escape (const std::string& value);
-  std::string build_failure_message (const std::string& file, int line, std::string const& message);
-
-  ReporterXml (ReporterXml const&) = delete;
-  ReporterXml& operator=(ReporterXml const&) = delete;
 
   std::ostream& os;
   std::chrono::system_clock::time_point start_time;
   std::ios orig_state;
-};
+  std::streampos report_start;  ///< Start of report or -1 if stream is not seekable
+  std::streampos report_end;    ///< End of previous report or -1
+  bool report_written;          ///< `true` if a report has been written since Clear()
 
-inline
-std::string ReporterXml::xml_escape (const std::string& value)
-{
-  //TODO trade style for speed
-  std::string escaped = value;
-  auto replace_char = [&escaped] (char c, const char* repl){
-    for (auto pos = escaped.find(c); pos != std::string::npos; pos = escaped.find(c, pos + 1))
-      escaped.replace(pos, 1, repl);
-
-  };
-  replace_char ('&', "&amp;");
-  replace_char ('<', "&lt;");
-  replace_char ('>', "&gt;");
-  replace_char ('\'', "&apos;");
-  replace_char ('\"', "&quot;");
-
-  return escaped;
-}
-
-inline
-std::string ReporterXml::build_failure_message (const std::string& file, int line, std::string const& message)
-{
-  std::ostringstream failureMessage;
-  failureMessage << file << "(" << line << ") : " << message;
-  return failureMessage.str();
-}
+private:
+  ReporterXml (ReporterXml const&) = delete;
+  ReporterXml& operator=(ReporterXml const&) = delete;
+};
 
 /*!
   Constructor.
@@ -106,6 +88,9 @@ inline
 ReporterXml::ReporterXml (std::ostream& ostream)
   : os (ostream)
   , orig_state (nullptr)
+  , report_start (ostream.tellp ())
+  , report_end (-1)
+  , report_written (false)
 {
   start_time = std::chrono::system_clock::now();
   orig_state.copyfmt (os);
@@ -117,35 +102,126 @@ ReporterXml::ReporterXml (std::ostream& ostream)
 inline
 int ReporterXml::Summary ()
 {
-  using namespace std::chrono;
-
-  std::string suite;
+  Symbol suite;
   os.copyfmt (orig_state);
-  auto end_time = time_point_cast<std::chrono::seconds>(std::chrono::system_clock::now ());
+  os << std::fixed << std::setprecision (3);
+
+  os << "<utpp-results" << totals () << ">\n";
+  AddStartTime ();
+  AddCommandLine ();
+
+  for (auto& r : results)
+  {
+    if (!r.benchmarks.empty ())
+    {
+      AddEnvironment ();
+      break;
+    }
+  }
+
+  for (auto i = results.cbegin (); i != results.cend (); ++i)
+  {
+    if (i->test_name.empty ()) // New suite flag
+    {
+      if (!suite.empty ())
+        os << " </suite>\n";
+      suite = i->suite_name;
+      if (suite == DEFAULT_SUITE)
+        os << " <suite";
+      else
+        os << " <suite name=\"" << suite << '\"';
+      if ((i + 1) == results.cend () || (i + 1)->test_name.empty ())
+      {
+        // Next record is another suite. This suite is either empty or disabled
+        os << " /";
+        suite = Symbol ();
+      }
+      os << ">\n";
+    }
+    else
+    {
+      BeginTest (*i);
+
+      if (!i->benchmarks.empty () || !i->failures.empty ())
+        os << ">\n"; // close <test> element
+      if (!i->benchmarks.empty ())
+        AddBenchmarks (*i);
+      if (!i->failures.empty ())
+        AddFailure (*i);
+
+      EndTest (*i);
+    }
+  }
+  if (!suite.empty ())
+    os << " </suite>\n";
+  AddEndTime ();
+  os << "</utpp-results>\n";
+  EraseTail ();
+  return ReporterDeferred::Summary ();
+}
+
+/*!
+  Overwrite with spaces any part of a previous, longer, report that was not
+  overwritten by the current one.
+
+  Output streams cannot be truncated, so when the same stream is used for
+  several runs, the end of a previous report would remain after the current
+  one. White space after the root element keeps the document well-formed.
+*/
+inline
+void ReporterXml::EraseTail ()
+{
+  auto end = os.tellp ();
+  if (end != std::streampos (-1) && report_end != std::streampos (-1) && end < report_end)
+    os << std::string ((size_t)(report_end - end), ' ');
+  auto pos = os.tellp ();
+  if (pos != std::streampos (-1) && (report_end == std::streampos (-1) || pos > report_end))
+    report_end = pos;
+  report_written = true;
+  os.flush ();
+}
+
+/// Return attributes of root element with total counts and duration
+inline
+std::string ReporterXml::totals ()
+{
+  using namespace std::chrono;
   auto total_time_s = duration_cast<duration<float, std::chrono::seconds::period>>(total_time);
 
-  os << "<utpp-results"
-    << " total=\"" << total_test_count << '\"'
+  std::ostringstream attr;
+  attr << " total=\"" << total_test_count << '\"'
     << " failed=\"" << total_failed_count << '\"'
     << " failures=\"" << total_failures_count << '\"' << " duration=\"" << std::fixed << std::setprecision (3)
 #if UTPP_STD_CHRONO_OSTREAM_AVAILABLE
-    << total_time_s << '\"'
+    << total_time_s << '\"';
 #else
-    << total_time_s.count() << "s\""
+    << total_time_s.count() << "s\"";
 #endif
-    << '>' << std::endl;
+  return attr.str ();
+}
+
+/// Output start time of tests
+inline
+void ReporterXml::AddStartTime ()
+{
+  using namespace std::chrono;
 #if defined(__cpp_lib_format)
   auto start_time_sec = time_point_cast<std::chrono::seconds>(start_time);
-  os << " <start-time>" << std::format("{0:%F} {0:%T}Z", start_time_sec) << "</start-time>" << std::endl;
+  os << " <start-time>" << std::format("{0:%F} {0:%T}Z", start_time_sec) << "</start-time>\n";
 #else
   struct tm* timeinfo;
   char buffer[80];
   time_t t = system_clock::to_time_t (start_time);
   timeinfo = gmtime (&t);
   strftime (buffer, sizeof(buffer), "%F %TZ", timeinfo);
-  os << " <start-time>" << buffer << "</start-time>" << std::endl;
+  os << " <start-time>" << buffer << "</start-time>\n";
 #endif
+}
 
+/// Output command line of test program
+inline
+void ReporterXml::AddCommandLine ()
+{
 #ifdef _WIN32
   std::string cmd;
   std::wstring wcmd{ GetCommandLineW () };
@@ -156,65 +232,46 @@ int ReporterXml::Summary ()
     WideCharToMultiByte (CP_UTF8, 0, wcmd.c_str (), -1, &cmd[0], nsz, 0, 0);
     cmd.resize (nsz - 1); //output is null-terminated
   }
-  os << " <command-line>" << xml_escape (cmd) << "</command-line>" << std::endl;
+  os << " <command-line>" << xml_escape (cmd) << "</command-line>\n";
 #else
   std::ifstream cmd_stream("/proc/self/cmdline");
   if (cmd_stream.good ()) 
   {
     std::string cmd;
     std::getline(cmd_stream, cmd, '\0');
-    os << " <command-line>" << xml_escape (cmd) << "</command-line>" << std::endl;
+    os << " <command-line>" << xml_escape (cmd) << "</command-line>\n";
   }
 #endif
+}
 
-  for (auto i = results.cbegin (); i != results.cend (); ++i)
-  {
-    if (i->test_name.empty ()) // New suite flag
-    {
-      if (!suite.empty ())
-        os << " </suite>" << std::endl;
-      suite = i->suite_name;
-      if (suite == DEFAULT_SUITE)
-        os << " <suite";
-      else
-        os << " <suite name=\"" << suite << '\"';
-      if ((i + 1) == results.cend () || (i + 1)->test_name.empty ())
-      {
-        // Next record is another suite. This suite is either empty or disabled
-        os << " /";
-        suite.clear ();
-      }
-      os << '>' << std::endl;
-    }
-    else
-    {
-      BeginTest (*i);
-
-      if (!i->failures.empty ())
-        AddFailure (*i);
-
-      EndTest (*i);
-    }
-  }
-  if (!suite.empty ())
-    os << " </suite>" << std::endl;
+/// Output current time as end time of tests
+inline
+void ReporterXml::AddEndTime ()
+{
+  using namespace std::chrono;
+  auto end_time = time_point_cast<std::chrono::seconds>(std::chrono::system_clock::now ());
 #if defined(__cpp_lib_format)
-  os << " <end-time>" << std::format ("{0:%F} {0:%T}Z", end_time) << "</end-time>" << std::endl;
+  os << " <end-time>" << std::format ("{0:%F} {0:%T}Z", end_time) << "</end-time>\n";
 #else
-  t = system_clock::to_time_t (end_time);
+  struct tm* timeinfo;
+  char buffer[80];
+  time_t t = system_clock::to_time_t (end_time);
   timeinfo = gmtime (&t);
   strftime (buffer, sizeof (buffer), "%F %TZ", timeinfo);
-  os << " <end-time>" << buffer << "</end-time>" << std::endl;
+  os << " <end-time>" << buffer << "</end-time>\n";
 #endif
-  os << "</utpp-results>" << std::endl;
-  return ReporterDeferred::Summary ();
 }
 
 inline
 void ReporterXml::Clear ()
 {
-  os.seekp (0);
-  os << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>" << std::endl;
+  // Rewrite report if stream is seekable; otherwise start a new document
+  // only if a report has already been written.
+  if (report_start != std::streampos (-1))
+    os.seekp (report_start);
+  if (report_start != std::streampos (-1) || report_written)
+    os << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>" << std::endl;
+  report_written = false;
   start_time = std::chrono::system_clock::now();
 
   ReporterDeferred::Clear ();
@@ -223,37 +280,164 @@ void ReporterXml::Clear ()
 inline
 void ReporterXml::BeginTest (const ReporterDeferred::TestResult& result)
 {
+  //test time is in milliseconds with nanosecond resolution
+  auto prec = os.precision (6);
   os << "  <test"
     << " name=\"" << result.test_name << "\""
-#if UTPP_STD_CHRONO_OSTREAM_AVAILABLE
-    << " time=\"" << result.test_time << "\"";
-#else
-    << " time=\"" << result.test_time.count() << "ms\"";
-#endif
+    << " time=\"" << std::chrono::duration<double, std::milli> (result.test_time).count ()
+    << "ms\"";
+  os.precision (prec);
+  if (alloc_tracking_installed ())
+  {
+    os << " allocations=\"" << result.allocs.count << '\"'
+      << " allocated-bytes=\"" << result.allocs.bytes << '\"'
+      << " peak-bytes=\"" << result.allocs.peak << '\"'
+      << " leaked-bytes=\"" << result.allocs.leaked << '\"';
+  }
+  if (track_resources)
+  {
+    for (auto& c : resource_counters ())
+      os << ' ' << c.name << "=\"" << result.rusage.*c.value << '\"';
+  }
+  AddPerfCounters (result.perf);
+}
+
+/*!
+  Output available performance counters and ratios derived from them as
+  attributes of the current element.
+  \param pc          Counter values
+  \param iterations  If not 0, counters are divided by this number
+*/
+inline
+void ReporterXml::AddPerfCounters (const PerfCounters& pc, double iterations)
+{
+  double div = iterations > 0 ? iterations : 1.;
+  for (size_t i = 0; i < PERF_EVENTS; ++i)
+  {
+    if (perf_event_available (i))
+    {
+      auto& ev = perf_events ()[i];
+      os << ' ' << ev.name << "=\"";
+      if (iterations > 0)
+        os << pc.*ev.value / div;
+      else
+        os << pc.*ev.value;
+      os << '\"';
+    }
+  }
+  if (perf_event_available (0) && perf_event_available (1))
+    os << " ipc=\"" << perf_ipc (pc) << '\"';
+  if (perf_event_available (2) && perf_event_available (3))
+    os << " cache-miss-rate=\"" << perf_cache_miss_rate (pc) << '\"';
+  if (perf_event_available (4) && perf_event_available (5))
+    os << " branch-miss-rate=\"" << perf_branch_miss_rate (pc) << '\"';
 }
 
 inline
 void ReporterXml::EndTest (const ReporterDeferred::TestResult& result)
 {
-  if (result.failures.empty ())
+  if (result.benchmarks.empty () && result.failures.empty ())
     os << "/>";
   else
     os << "  </test>";
 
-  os << std::endl;
+  os << '\n';
 }
 
+/// Output the environment in which benchmarks have run
 inline
-void ReporterXml::AddFailure (const ReporterDeferred::TestResult& result)
+void ReporterXml::AddEnvironment ()
 {
-  os << ">" << std::endl; // close <test> element
+  auto& env = benchmark_environment ();
+  os << " <environment cpu-model=\"" << xml_escape (env.cpu_model) << '\"'
+    << " cpus=\"" << env.cpus << '\"';
+  if (env.mhz > 0)
+    os << " mhz=\"" << env.mhz << '\"';
+  if (!env.governor.empty ())
+    os << " governor=\"" << xml_escape (env.governor) << '\"';
+  if (env.smt >= 0)
+    os << " smt=\"" << (env.smt ? "on" : "off") << '\"';
+  if (env.load_avg[0] >= 0)
+  {
+    os << " load-average=\"" << env.load_avg[0] << ' ' << env.load_avg[1]
+      << ' ' << env.load_avg[2] << '\"';
+  }
+  if (env.pinned_cpu >= 0)
+    os << " pinned-cpu=\"" << env.pinned_cpu << '\"';
+  os << "/>\n";
+}
 
-  for (auto& fail : result.failures)
+/*!
+  Output benchmark results, one element for each set of arguments, followed
+  by the complexity fit if there is one.
+*/
+inline
+void ReporterXml::AddBenchmarks (const ReporterDeferred::TestResult& result)
+{
+  for (auto& b : result.benchmarks)
   {
-    std::string escapedMessage = xml_escape (fail.message);
-    std::string message = build_failure_message (fail.filename, fail.line_number, escapedMessage);
+    os << "   <benchmark";
+    if (!b.args.empty ())
+    {
+      os << " args=\"";
+      for (size_t j = 0; j < b.args.size (); ++j)
+        os << (j ? "/" : "") << b.args[j];
+      os << '\"';
+    }
+    os << " iterations=\"" << b.iterations << '\"'
+      << " repetitions=\"" << b.repetitions << '\"'
+      << " mean-ns=\"" << b.mean << '\"'
+      << " median-ns=\"" << b.median << '\"'
+      << " stddev-ns=\"" << b.stddev << '\"'
+      << " min-ns=\"" << b.min << '\"';
+    if (b.bytes_rate > 0)
+      os << " bytes-per-second=\"" << b.bytes_rate << '\"';
+    if (b.items_rate > 0)
+      os << " items-per-second=\"" << b.items_rate << '\"';
+    if (b.threads)
+    {
+      os << " threads=\"" << b.threads << '\"'
+        << " total-rate=\"" << b.total_rate << '\"'
+        << " thread-rate=\"" << b.thread_rate << '\"'
+        << " efficiency=\"" << b.efficiency << '\"';
+    }
+    if (b.comparison.verdict != vNoBaseline)
+    {
+      static const char* attr[] = { " baseline-ns=\"", " baseline-bytes-per-second=\"",
+        " baseline-items-per-second=\"" };
+      os << attr[b.comparison.metric] << b.comparison.baseline << '\"'
+        << " delta=\"" << b.comparison.delta << '\"'
+        << " p-value=\"" << b.comparison.p_value << '\"'
+        << " verdict=\"" << verdict_name (b.comparison.verdict) << '\"';
+    }
+    if (b.latency.samples)
+    {
+      os << " latency-samples=\"" << b.latency.samples << '\"'
+        << " p50-ns=\"" << b.latency.p50 << '\"'
+        << " p90-ns=\"" << b.latency.p90 << '\"'
+        << " p99-ns=\"" << b.latency.p99 << '\"'
+        << " p999-ns=\"" << b.latency.p999 << '\"'
+        << " max-ns=\"" << b.latency.max << '\"';
+    }
+    AddPerfCounters (b.perf, (double)b.iterations * b.repetitions);
+    os << "/>\n";
+  }
+  if (result.complexity.big_o != oNone)
+  {
+    os << "   <complexity big-o=\"" << big_o_name (result.complexity.big_o) << '\"'
+      << " coefficient=\"" << result.complexity.coefficient << '\"'
+      << " rms=\"" << result.complexity.rms << '\"'
+      << "/>\n";
+  }
+}
 
-    os << "   <failure" << " message=\"" << message << "\"" << "/>" << std::endl;
+inline
+void ReporterXml::AddFailure (const ReporterDeferred::TestResult& result)
+{
+  for (auto& fail : result.failures)
+  {
+    os << "   <failure message=\"" << xml_escape (fail.filename.str ()) << '('
+      << fail.line_number << ") : " << xml_escape (fail.message) << "\"/>\n";
   }
 }
 
@@ -0,0 +1,197 @@
+#pragma once
+/*
+  UTPP - A New Generation of UnitTest++
+  (c) Mircea Neacsu 2017-2025
+
+  See LICENSE file for full copyright information.
+*/
+
+/*!
+  \file reporter_xml_streaming.h
+  \brief Definition of UnitTest::ReporterXmlStreaming class
+*/
+
+namespace UnitTest
+{
+
+/*!
+  A Reporter that writes XML formatted results as tests finish.
+
+  The report has the same format as the one produced by ReporterXml but
+  each test is written as soon as its results are complete and only the
+  results of the current test are kept in memory. A test is written when the
+  next test starts or when the suite finishes, so that failures reported
+  while the test fixture is destroyed are included. The output stream is
+  flushed at the end of each suite and after each failed test.
+
+  Totals are not known when the root element is written. If the output
+  stream is seekable, space is reserved in the root element and it is
+  filled with the totals by Summary(). Otherwise, totals are written in a
+  `<totals>` element at the end of the report.
+
+  If the program is killed, the report contains all tests written before the
+  last flush. It can be repaired by removing any incomplete last line and
+  appending the missing `</suite>` and `</utpp-results>` end tags.
+*/
+class ReporterXmlStreaming : public ReporterXml
+{
+public:
+  explicit ReporterXmlStreaming (std::ostream& ostream = std::cout);
+
+  void SuiteStart (const TestSuite& suite) override;
+  void TestStart (const Test& test) override;
+  int SuiteFinish (const TestSuite& suite) override;
+  int Summary () override;
+  void Clear () override;
+
+private:
+  void WriteHeader ();
+  void WriteTest ();
+
+  /// Space reserved for totals in root element
+  static const size_t TOTALS_WIDTH = 120;
+
+  bool header_written;      ///< `true` if root element has been written
+  bool suite_open;          ///< `true` if a suite element is open
+  bool env_written;         ///< `true` if environment element has been written
+  std::streampos totals_pos;  ///< Position of totals or -1 if stream is not seekable
+};
+
+/*!
+  Constructor.
+
+  \param ostream Output stream that will contain XML formatted results
+*/
+inline
+ReporterXmlStreaming::ReporterXmlStreaming (std::ostream& ostream)
+  : ReporterXml (ostream)
+  , header_written (false)
+  , suite_open (false)
+  , env_written (false)
+  , totals_pos (-1)
+{
+}
+
+/// Write root element, start time and command line
+inline
+void ReporterXmlStreaming::WriteHeader ()
+{
+  if (header_written)
+    return;
+  os.copyfmt (orig_state);
+  os << "<utpp-results";
+  totals_pos = os.tellp ();
+  if (totals_pos != std::streampos (-1))
+    os << std::string (TOTALS_WIDTH, ' ');
+  os << ">\n";
+  os << std::fixed << std::setprecision (3);
+  AddStartTime ();
+  AddCommandLine ();
+  header_written = true;
+}
+
+/// Start a new suite element
+inline
+void ReporterXmlStreaming::SuiteStart (const TestSuite& suite)
+{
+  results.clear ();
+  ReporterXml::SuiteStart (suite);
+  WriteHeader ();
+  if (suite.name == DEFAULT_SUITE)
+    os << " <suite>\n";
+  else
+    os << " <suite name=\"" << suite.name << "\">\n";
+  suite_open = true;
+}
+
+/// Write previous test before starting a new one
+inline
+void ReporterXmlStreaming::TestStart (const Test& test)
+{
+  WriteTest ();
+  ReporterXml::TestStart (test);
+}
+
+/// Write test element of last test, if not already written, and forget its results
+inline
+void ReporterXmlStreaming::WriteTest ()
+{
+  if (results.empty () || results.back ().test_name.empty ())
+    return; //no test or only the suite record
+  auto& r = results.back ();
+  if (!r.benchmarks.empty () && !env_written)
+  {
+    AddEnvironment ();
+    env_written = true;
+  }
+  BeginTest (r);
+  if (!r.benchmarks.empty () || !r.failures.empty ())
+    os << ">\n"; // close <test> element
+  if (!r.benchmarks.empty ())
+    AddBenchmarks (r);
+  if (!r.failures.empty ())
+    AddFailure (r);
+  EndTest (r);
+  if (!r.failures.empty ())
+    os.flush ();
+  results.pop_back ();
+}
+
+/// Close suite element and flush output stream
+inline
+int ReporterXmlStreaming::SuiteFinish (const TestSuite& suite)
+{
+  WriteTest ();
+  if (suite_open)
+  {
+    os << " </suite>" << std::endl;
+    suite_open = false;
+  }
+  return ReporterXml::SuiteFinish (suite);
+}
+
+/// Finish XML report and write totals
+inline
+int ReporterXmlStreaming::Summary ()
+{
+  WriteHeader ();
+  WriteTest ();
+  if (suite_open)
+  {
+    os << " </suite>\n";
+    suite_open = false;
+  }
+  AddEndTime ();
+
+  std::string attr = totals ();
+  bool patched = false;
+  if (totals_pos != std::streampos (-1) && attr.size () <= TOTALS_WIDTH)
+  {
+    auto end = os.tellp ();
+    if (os.seekp (totals_pos))
+    {
+      os << attr;
+      patched = (bool)os.seekp (end);
+    }
+    os.clear ();
+  }
+  if (!patched)
+    os << " <totals" << attr << "/>\n";
+  os << "</utpp-results>\n";
+  EraseTail ();
+  results.clear ();
+  return ReporterDeferred::Summary ();
+}
+
+/// Restart report
+inline
+void ReporterXmlStreaming::Clear ()
+{
+  ReporterXml::Clear ();
+  header_written = false;
+  suite_open = false;
+  env_written = false;
+  totals_pos = -1;
+}
+
+}
@@ -0,0 +1,173 @@
+#pragma once
+/*
+  UTPP - A New Generation of UnitTest++
+  (c) Mircea Neacsu 2017-2025
+
+  See LICENSE file for full copyright information.
+*/
+
+/*!
+  \file rusage.h
+  \brief Operating system resource usage of tests
+
+  Resource usage tracking is optional. To enable it, set the
+  `UnitTest::track_resources` flag before running the tests:
+  ```
+  UnitTest::track_resources = true;
+  UnitTest::RunAllTests ();
+  ```
+  Counters are obtained from `getrusage` function and, on Linux, from
+  `/proc/self/io` file. On systems where they are not available, all counters
+  are 0.
+*/
+
+#include <array>
+#include <cstdio>
+#include <cstring>
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+namespace UnitTest {
+
+/// Operating system resources used by a test
+struct ResourceUsage
+{
+  long long max_rss;          ///< Increase of peak resident set size (KB)
+  long long minor_faults;     ///< Page faults serviced without I/O
+  long long major_faults;     ///< Page faults that required I/O
+  long long vol_switches;     ///< Voluntary context switches
+  long long invol_switches;   ///< Involuntary context switches
+  long long read_bytes;       ///< Bytes read from storage
+  long long write_bytes;      ///< Bytes written to storage
+};
+
+/// Description of a ResourceUsage counter
+struct ResourceCounter
+{
+  const char* name;                 ///< Name used in XML reports
+  const char* description;          ///< Human readable description
+  long long ResourceUsage::*value;  ///< Counter in ResourceUsage structure
+};
+
+#if UTPP_CPP_LANG < 201703L
+/// If `true`, resources used by each test are measured
+extern bool track_resources;
+#else
+/// If `true`, resources used by each test are measured
+inline bool track_resources = false;
+#endif
+
+/// Number of counters in ResourceUsage structure
+const size_t RESOURCE_COUNTERS = 7;
+
+/// Return the list of resource counters
+inline
+const std::array<ResourceCounter, RESOURCE_COUNTERS>& resource_counters ()
+{
+  static const std::array<ResourceCounter, RESOURCE_COUNTERS> counters{ {
+    { "max-rss-kb", "peak RSS increase (KB)", &ResourceUsage::max_rss },
+    { "minor-faults", "minor page faults", &ResourceUsage::minor_faults },
+    { "major-faults", "major page faults", &ResourceUsage::major_faults },
+    { "voluntary-switches", "voluntary context switches", &ResourceUsage::vol_switches },
+    { "involuntary-switches", "involuntary context switches", &ResourceUsage::invol_switches },
+    { "read-bytes", "bytes read", &ResourceUsage::read_bytes },
+    { "write-bytes", "bytes written", &ResourceUsage::write_bytes }
+  } };
+  return counters;
+}
+
+/*!
+  Return current resource usage counters.
+
+  Page faults and context switches are those of the calling thread if the
+  system can report them per thread, otherwise those of the whole process.
+  Memory and I/O counters always refer to the whole process.
+*/
+inline
+ResourceUsage current_resource_usage ()
+{
+  ResourceUsage ru{};
+#if defined(__unix__) || defined(__APPLE__)
+  rusage r;
+#if defined(RUSAGE_THREAD)
+  if (getrusage (RUSAGE_THREAD, &r) == 0)
+#else
+  if (getrusage (RUSAGE_SELF, &r) == 0)
+#endif
+  {
+#if defined(__APPLE__)
+    ru.max_rss = r.ru_maxrss / 1024; //bytes on macOS
+#else
+    ru.max_rss = r.ru_maxrss;
+#endif
+    ru.minor_faults = r.ru_minflt;
+    ru.major_faults = r.ru_majflt;
+    ru.vol_switches = r.ru_nvcsw;
+    ru.invol_switches = r.ru_nivcsw;
+  }
+#endif
+#if defined(__linux__)
+  // FILE functions use malloc, not operator new, and are not counted as
+  // test allocations
+  FILE* f = fopen ("/proc/self/io", "r");
+  if (f)
+  {
+    char key[32];
+    long long val;
+    while (fscanf (f, "%31[^:]: %lld ", key, &val) == 2)
+    {
+      if (!strcmp (key, "read_bytes"))
+        ru.read_bytes = val;
+      else if (!strcmp (key, "write_bytes"))
+        ru.write_bytes = val;
+    }
+    fclose (f);
+  }
+#endif
+  return ru;
+}
+
+/*!
+  Measures resources used between the creation of the object and a call to
+  usage() function.
+
+  If `track_resources` flag is not set, the meter does nothing and all
+  counters are 0.
+*/
+class ResourceMeter
+{
+public:
+  ResourceMeter ();
+  ResourceUsage usage () const;
+
+private:
+  bool active;
+  ResourceUsage start;
+};
+
+/// Take a snapshot of current resource usage
+inline
+ResourceMeter::ResourceMeter ()
+  : active (track_resources)
+  , start ()
+{
+  if (active)
+    start = current_resource_usage ();
+}
+
+/// Return resources used since the meter was created
+inline
+ResourceUsage ResourceMeter::usage () const
+{
+  ResourceUsage ru{};
+  if (active)
+  {
+    ru = current_resource_usage ();
+    for (auto& c : resource_counters ())
+      ru.*c.value -= start.*c.value;
+  }
+  return ru;
+}
+
+} //namespace UnitTest
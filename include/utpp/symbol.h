@@ -0,0 +1,160 @@
+#pragma once
+/*
+  UTPP - A New Generation of UnitTest++
+  (c) Mircea Neacsu 2017-2025
+
+  See LICENSE file for full copyright information.
+*/
+
+/*!
+  \file symbol.h
+  \brief Definition of UnitTest::Symbol class (interned strings)
+
+  Suite, test and file names are used over and over during a test run. Each
+  distinct name is stored only once in a global table and the rest of the
+  program keeps only Symbol objects that refer to it.
+*/
+
+#include <string>
+#include <cstring>
+#include <ostream>
+#include <unordered_map>
+#include <mutex>
+
+namespace UnitTest {
+
+/*!
+  An interned string.
+
+  Symbols are cheap to copy and compare: two symbols are equal if they have
+  the same id. The string itself is kept in the global symbol table and is
+  never released.
+*/
+class Symbol
+{
+public:
+  Symbol ();
+  Symbol (const std::string& s);
+  Symbol (const char* s);
+
+  /// Return symbol id. Id of the empty string is 0.
+  unsigned id () const { return idx; }
+
+  /// Return symbol string
+  const std::string& str () const { return *ptr; }
+
+  /// Return symbol string as a C string
+  const char* c_str () const { return ptr->c_str (); }
+
+  /// Return `true` if this is the empty string
+  bool empty () const { return idx == 0; }
+
+  /// Symbols can be used wherever a string is required
+  operator const std::string& () const { return *ptr; }
+
+private:
+  void intern (const char* s, size_t len);
+
+  const std::string* ptr;
+  unsigned idx;
+};
+
+/// Global table of interned strings
+struct SymbolTable
+{
+  SymbolTable ();
+  static SymbolTable& instance ();
+
+  std::mutex lock;                                ///< protects the table
+  std::unordered_map<std::string, unsigned> ids;  ///< interned strings
+  std::string key;                                ///< lookup key, reused to avoid allocations
+  const std::string* empty;                       ///< the empty string (id 0)
+};
+
+/// Constructor. The empty string gets id 0.
+inline
+SymbolTable::SymbolTable ()
+{
+  empty = &ids.emplace (std::string (), 0).first->first;
+}
+
+/// Return the global symbol table
+inline
+SymbolTable& SymbolTable::instance ()
+{
+  static SymbolTable table;
+  return table;
+}
+
+/*!
+  Add a string to the symbol table if not already there.
+
+  Strings already in the table are found without allocating memory.
+*/
+inline
+void Symbol::intern (const char* s, size_t len)
+{
+  auto& table = SymbolTable::instance ();
+  if (!len)
+  {
+    ptr = table.empty;
+    idx = 0;
+    return;
+  }
+  std::lock_guard<std::mutex> guard (table.lock);
+  table.key.assign (s, len);
+  auto p = table.ids.find (table.key);
+  if (p == table.ids.end ())
+    p = table.ids.emplace (table.key, (unsigned)table.ids.size ()).first;
+  ptr = &p->first;
+  idx = p->second;
+}
+
+/// Create the empty string symbol
+inline
+Symbol::Symbol ()
+  : ptr (SymbolTable::instance ().empty)
+  , idx (0)
+{
+}
+
+/// Create a symbol for a string
+inline
+Symbol::Symbol (const std::string& s)
+{
+  intern (s.data (), s.size ());
+}
+
+/// Create a symbol for a C string
+inline
+Symbol::Symbol (const char* s)
+{
+  intern (s, s ? strlen (s) : 0);
+}
+
+///@{
+/// Symbols comparison
+inline bool operator== (const Symbol& lhs, const Symbol& rhs) { return lhs.id () == rhs.id (); }
+inline bool operator!= (const Symbol& lhs, const Symbol& rhs) { return lhs.id () != rhs.id (); }
+///@}
+
+///@{
+/// Comparison between symbols and strings
+inline bool operator== (const Symbol& lhs, const std::string& rhs) { return lhs.str () == rhs; }
+inline bool operator== (const std::string& lhs, const Symbol& rhs) { return lhs == rhs.str (); }
+inline bool operator!= (const Symbol& lhs, const std::string& rhs) { return lhs.str () != rhs; }
+inline bool operator!= (const std::string& lhs, const Symbol& rhs) { return lhs != rhs.str (); }
+inline bool operator== (const Symbol& lhs, const char* rhs) { return lhs.str () == rhs; }
+inline bool operator== (const char* lhs, const Symbol& rhs) { return lhs == rhs.str (); }
+inline bool operator!= (const Symbol& lhs, const char* rhs) { return lhs.str () != rhs; }
+inline bool operator!= (const char* lhs, const Symbol& rhs) { return lhs != rhs.str (); }
+///@}
+
+/// Output a symbol to a stream
+inline
+std::ostream& operator<< (std::ostream& os, const Symbol& s)
+{
+  return os << s.str ();
+}
+
+} //namespace UnitTest
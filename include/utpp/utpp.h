@@ -21,10 +21,13 @@
 
 #include <string>
 #include <deque>
+#include <vector>
 #include <stdexcept>
 #include <sstream>
 #include <cassert>
 #include <chrono>
+#include <cstdarg>
+#include <cstdio>
 #ifndef _WIN32
 #include <sys/stat.h>
 #include <unistd.h>
@@ -41,6 +44,13 @@
 #define UTPP_CPP_LANG _MSVC_LANG
 #endif
 
+#if UTPP_CPP_LANG >= 202002L
+#include <version>
+#endif
+#if defined(__cpp_lib_format)
+#include <format>
+#endif
+
 
 #if ((UTPP_CPP_LANG >= 202002L && \
   (!defined(_LIBCPP_VERSION) || _LIBCPP_VERSION >= 160000)))
@@ -49,14 +59,63 @@
 #define UTPP_STD_CHRONO_OSTREAM_AVAILABLE 0
 #endif
 
+/*
+  UTPP_COLD marks functions that are called only when a check fails. They are
+  kept out of line so that CHECK macros expand to as little code as possible.
+  UTPP_UNLIKELY tells the compiler which branch leads to these functions.
+*/
+#if defined(__GNUC__) || defined(__clang__)
+#define UTPP_COLD __attribute__ ((noinline, cold))
+#elif defined(_MSC_VER)
+#define UTPP_COLD __declspec(noinline)
+#else
+#define UTPP_COLD
+#endif
+
+/*
+  UTPP_NOINLINE keeps a function out of line without moving it away from
+  frequently executed code.
+*/
+#if defined(__GNUC__) || defined(__clang__)
+#define UTPP_NOINLINE __attribute__ ((noinline))
+#elif defined(_MSC_VER)
+#define UTPP_NOINLINE __declspec(noinline)
+#else
+#define UTPP_NOINLINE
+#endif
+
+#if UTPP_CPP_LANG >= 202002L
+#define UTPP_UNLIKELY [[unlikely]]
+#else
+#define UTPP_UNLIKELY
+#endif
+
+/// Lets GCC and clang verify arguments of printf-like functions
+#if defined(__GNUC__) || defined(__clang__)
+#define UTPP_PRINTF_FORMAT(fmt, args) __attribute__ ((format (printf, fmt, args)))
+#else
+#define UTPP_PRINTF_FORMAT(fmt, args)
+#endif
+
 // --------------- Global configuration options -------------------------------
 #define UTPP_VERSION "3.0.2"
 
 // --------------- end of configuration options -------------------------------
 
+#include "alloc.h"
+#include "rusage.h"
+#include "perf.h"
+#include "symbol.h"
+#include "clock.h"
+
 namespace UnitTest {
 
-///Maximum size of message buffer for ..._EX macro definitions
+/*!
+  Maximum size of message buffer for ..._EX macro definitions.
+
+  Kept only for compatibility with previous versions. Messages are now
+  formatted in a buffer that grows as needed.
+*/
 const size_t MAX_MESSAGE_SIZE = 1024;
 
 }
@@ -97,7 +156,16 @@ const size_t MAX_MESSAGE_SIZE = 1024;
 UnitTest::Test *UnitTest::CurrentTest; \
 UnitTest::Reporter *UnitTest::CurrentReporter; \
 double UnitTest::default_tolerance; \
-std::string UnitTest::CurrentSuite; \
+bool UnitTest::fail_on_leaks; \
+bool UnitTest::track_resources; \
+bool UnitTest::track_perf_counters; \
+UnitTest::Symbol UnitTest::CurrentSuite; \
+std::chrono::milliseconds UnitTest::benchmark_min_time{ 100 }; \
+int UnitTest::benchmark_repetitions = 5; \
+std::chrono::milliseconds UnitTest::benchmark_warmup{ 0 }; \
+int UnitTest::benchmark_cpu = -1; \
+bool UnitTest::benchmark_high_priority; \
+UnitTest::BenchmarkBaseline UnitTest::benchmark_baseline; \
 int main (ARGC,ARGV)
 #else
 #define TEST_MAIN(ARGC, ARGV) int main (ARGC, ARGV)
@@ -197,14 +265,29 @@ int main (ARGC,ARGV)
 
   \hideinitializer
 */
-#define ABORT_EX(value, ...) \
+#define ABORT_EX(value, ...)                                                  \
   do                                                                          \
   {                                                                           \
-    if (UnitTest::Check(value)) {                                             \
-      char message[UnitTest::MAX_MESSAGE_SIZE];                               \
-      snprintf (message, UnitTest::MAX_MESSAGE_SIZE, __VA_ARGS__);            \
-      throw UnitTest::test_abort (__FILE__, __LINE__, message);               \
-    }                                                                         \
+    if (UnitTest::Check(value)) UTPP_UNLIKELY                                 \
+      UnitTest::Abortf (__FILE__, __LINE__, __VA_ARGS__);                     \
+  } while (0)
+
+#ifdef ABORT_FMT
+#error Macro ABORT_FMT is already defined
+#endif
+
+/*!
+  \def ABORT_FMT
+  \brief  Abort current test if `value` is __true__. Outputs the given
+          `std::format` style message.
+
+  \hideinitializer
+*/
+#define ABORT_FMT(value, ...)                                                 \
+  do                                                                          \
+  {                                                                           \
+    if (UnitTest::Check(value)) UTPP_UNLIKELY                                 \
+      UnitTest::AbortFmt (__FILE__, __LINE__, __VA_ARGS__);                   \
   } while (0)
 
 ///@}
@@ -230,26 +313,57 @@ int main (ARGC,ARGV)
 
 ///@}
 
+/// \ingroup alloc
+///@{
+
+/*!
+  \brief Defines a local (per scope) limit for heap allocations
+  \param max_count Maximum number of allocations
+  \param max_bytes Maximum number of bytes allocated
+
+  Requires allocation tracking (see `UTPP_TRACK_ALLOCATIONS`).
+
+  \hideinitializer
+*/
+#define UTPP_ALLOC_CONSTRAINT(max_count, max_bytes) \
+  UnitTest::AllocConstraint unitTest__allocConstraint__(max_count, max_bytes, __FILE__, __LINE__)
+
+/*!
+  \brief Checks that the rest of the current scope does not allocate memory
+
+  Requires allocation tracking (see `UTPP_TRACK_ALLOCATIONS`).
+
+  \hideinitializer
+*/
+#define UTPP_NO_ALLOC() UTPP_ALLOC_CONSTRAINT (0, 0)
+
+///@}
+
 namespace UnitTest {
 
 // forward declarations
 struct Failure;
 class TestSuite;
 
-void ReportFailure(const std::string& filename, int line, const std::string& message);
+void ReportFailure(const Symbol& filename, int line, const std::string& message);
 
 ///Representation of a test case
 class Test
 {
 public:
-  Test (const std::string& testName);
+  Test (const Symbol& testName);
   virtual ~Test() {};
   void no_time_constraint ();
   bool is_time_constraint () const;
 
   int failure_count () const;
+  std::chrono::nanoseconds test_time () const;
   std::chrono::milliseconds test_time_ms () const;
   const std::string& test_name () const;
+  const Symbol& test_symbol () const;
+  const AllocStats& alloc_stats () const;
+  const ResourceUsage& resource_usage () const;
+  const PerfCounters& perf_counters () const;
 
   void failure ();
   void run ();
@@ -258,25 +372,112 @@ public:
   virtual void RunImpl () {};
 
 protected:
-  std::string name;                   ///< Name of this test
+  Symbol name;                        ///< Name of this test
   int failures;                       ///< Number of failures in this test
-  std::chrono::milliseconds time;     ///< Run time
+  std::chrono::nanoseconds time;      ///< Run time
   bool time_exempt;                   ///< _true_ if exempt from time constraints
+  AllocStats allocs;                  ///< Heap allocations made by test
+  ResourceUsage rusage;               ///< Operating system resources used by test
+  PerfCounters perf;                  ///< Performance counters of test
 
 private:
   Test (Test const&) = delete;
   Test& operator =(Test const&) = delete;
   friend class TestSuite;
+  friend class AsyncReporter;
 };
 
 /// The failure object records the file name, the line number and a message
 struct Failure
 {
-  std::string filename;     ///< Name of file where a failure has occurred
+  Symbol filename;          ///< Name of file where a failure has occurred
   std::string message;      ///< Description of failure
   int line_number;          ///< Line number where the failure has occurred
 };
 
+/// Outcome of comparing benchmark results with a baseline
+enum Verdict
+{
+  vNoBaseline,              ///< Benchmark not found in baseline
+  vSame,                    ///< No significant difference
+  vFaster,                  ///< Significantly faster than baseline
+  vSlower                   ///< Significantly slower than baseline
+};
+
+/// Quantity compared with a baseline
+enum Metric
+{
+  mTime,                    ///< Time per iteration (nanoseconds)
+  mBytesRate,               ///< Bytes processed per second
+  mItemsRate                ///< Items processed per second
+};
+
+/// Comparison of benchmark results with a baseline
+struct BenchmarkComparison
+{
+  Verdict verdict;          ///< Comparison outcome
+  double baseline;          ///< Median value of metric in baseline
+  double delta;             ///< Relative change of median value
+  double p_value;           ///< Probability that difference is due to noise
+  Metric metric;            ///< Compared quantity
+};
+
+/// Distribution of operation latencies, in nanoseconds
+struct LatencyStats
+{
+  size_t samples;           ///< Number of measured operations (0 if not measured)
+  long long p50;            ///< Median latency
+  long long p90;            ///< 90th percentile
+  long long p99;            ///< 99th percentile
+  long long p999;           ///< 99.9th percentile
+  long long max;            ///< Maximum latency
+};
+
+/// Results of a benchmark. Times are per iteration, in nanoseconds.
+struct BenchmarkStats
+{
+  std::vector<long long> args;  ///< Benchmark arguments (empty if none)
+  long long complexity_n;   ///< Problem size used for complexity fitting
+  size_t iterations;        ///< Number of iterations in each repetition
+  int repetitions;          ///< Number of repetitions
+  double mean;              ///< Mean time
+  double median;            ///< Median time
+  double stddev;            ///< Standard deviation of time
+  double min;               ///< Minimum time
+  std::vector<double> samples;  ///< Time of each repetition
+  PerfCounters perf;        ///< Performance counters of all repetitions
+  BenchmarkComparison comparison; ///< Comparison with baseline
+  LatencyStats latency;     ///< Latency distribution of latency benchmarks
+  int threads;              ///< Number of threads (0 if benchmark is not multithreaded)
+  double total_rate;        ///< Iterations per second of all threads
+  double thread_rate;       ///< Mean iterations per second of one thread
+  double efficiency;        ///< Scaling efficiency relative to first thread count
+  double bytes;             ///< Bytes processed per iteration (0 if not set)
+  double items;             ///< Items processed per iteration (0 if not set)
+  double bytes_rate;        ///< Bytes processed per second
+  double items_rate;        ///< Items processed per second
+};
+
+/// Asymptotic complexity classes
+enum BigO
+{
+  oNone,                    ///< No complexity fitting
+  o1,                       ///< Constant time
+  oLogN,                    ///< Logarithmic time
+  oN,                       ///< Linear time
+  oNLogN,                   ///< Linearithmic time
+  oNSquared,                ///< Quadratic time
+  oAuto                     ///< Find best fit without checking
+};
+
+/// Result of fitting benchmark times to a complexity class
+struct ComplexityFit
+{
+  BigO big_o;               ///< Best fit complexity class
+  double coefficient;       ///< Time (in nanoseconds) is coefficient * f(N)
+  double rms;               ///< Normalized RMS error of the fit
+};
+
 
 /// Abstract base for all reporters
 class Reporter
@@ -297,6 +498,12 @@ public:
   /// Called when a test has failed
   virtual void ReportFailure (const Failure& failure);
 
+  /// Called when a benchmark has finished all its repetitions
+  virtual void ReportBenchmark (const BenchmarkStats& stats);
+
+  /// Called when the results of a parameterized benchmark have been fitted
+  virtual void ReportComplexity (const ComplexityFit& fit);
+
   /// Invoked at the end of a test
   virtual void TestFinish (const Test& test);
 
@@ -313,12 +520,12 @@ protected:
   int suite_test_count,     ///< number of tests in suite
     suite_failed_count,     ///< number of failed tests in suite
     suite_failures_count;   ///< number of failures in suite
-  std::chrono::milliseconds suite_time; ///< total suite running time in milliseconds
+  std::chrono::nanoseconds suite_time; ///< total suite running time
 
   int total_test_count,     ///< total number of tests
     total_failed_count,     ///< total number of failed tests
     total_failures_count;   ///< total number of failures
-  std::chrono::milliseconds total_time;  ///< total running time in milliseconds
+  std::chrono::nanoseconds total_time;  ///< total running time
 
   int suites_count;         ///< number of suites ran
   bool trace;               ///< true if tracing is enabled
@@ -333,6 +540,8 @@ public:
   void SuiteStart (const TestSuite& suite) override;
   void TestStart (const Test& test) override;
   void ReportFailure (const Failure& failure) override;
+  void ReportBenchmark (const BenchmarkStats& stats) override;
+  void ReportComplexity (const ComplexityFit& fit) override;
   void TestFinish (const Test& test) override;
   void Clear () override;
 
@@ -341,11 +550,16 @@ protected:
   struct TestResult
   {
     TestResult ();
-    TestResult (const std::string& suite, const std::string& test);
-
-    std::string suite_name;         ///< suite name
-    std::string test_name;          ///< test name
-    std::chrono::milliseconds test_time;  ///< test running time in milliseconds
+    TestResult (const Symbol& suite, const Symbol& test);
+
+    Symbol suite_name;              ///< suite name
+    Symbol test_name;               ///< test name
+    std::chrono::nanoseconds test_time;   ///< test running time
+    AllocStats allocs;              ///< heap allocations made by test
+    ResourceUsage rusage;           ///< OS resources used by test
+    PerfCounters perf;              ///< performance counters of test
+    std::deque<BenchmarkStats> benchmarks;  ///< benchmark results
+    ComplexityFit complexity;       ///< complexity of a parameterized benchmark
     std::deque<Failure> failures;   ///< All failures of a test
   };
 
@@ -368,14 +582,14 @@ public:
   class Inserter
   {
   public:
-    Inserter (const std::string& suite,
-      const std::string& test,
-      const std::string& file,
+    Inserter (const Symbol& suite,
+      const Symbol& test,
+      const Symbol& file,
       int line,
       Testmaker func);
 
   private:
-    const std::string test_name,      ///< Test name
+    const Symbol test_name,           ///< Test name
       file_name;                      ///< Filename where test was declared
     const int line;                   ///< Line number where test was declared
     const Testmaker maker;            ///< Test maker function
@@ -383,17 +597,17 @@ public:
     friend class TestSuite;
   };
 
-  explicit TestSuite (const std::string& name);
+  explicit TestSuite (const Symbol& name);
   void Add (const Inserter* inf);
   bool IsEnabled () const;
   void Enable (bool on_off);
-  int RunTests (Reporter& reporter, std::chrono::milliseconds max_runtime);
+  int RunTests (Reporter& reporter, std::chrono::nanoseconds max_runtime);
 
-  std::string name;     ///< Suite name
+  Symbol name;          ///< Suite name
 
 private:
   std::deque <const Inserter*> test_list;  ///< tests included in this suite
-  std::chrono::milliseconds max_runtime;
+  std::chrono::nanoseconds max_runtime;
   bool enabled;
 
   bool SetupCurrentTest (const Inserter* inf);
@@ -401,7 +615,7 @@ private:
   void TearDownCurrentTest (const Inserter* inf);
 };
 
-/// An object that can be interrogated to get elapsed time
+/// An object that can be interrogated to get elapsed time (see clock.h)
 class Timer
 {
 public:
@@ -409,9 +623,10 @@ public:
   void Start ();
   std::chrono::milliseconds GetTimeInMs () const;
   std::chrono::microseconds GetTimeInUs () const;
+  std::chrono::nanoseconds GetTimeInNs () const;
 
 private:
-  std::chrono::steady_clock::time_point startTime;
+  long long startTime;
 };
 
 ///Defines maximum run time of a test
@@ -427,17 +642,35 @@ private:
   TimeConstraint (TimeConstraint const&) = delete;
 
   Timer timer;
-  std::string filename;
+  const char* filename;
   int line_number;
-  std::chrono::milliseconds tmax;
+  std::chrono::nanoseconds tmax;
+};
+
+///Defines maximum number of allocations and bytes allocated in a scope
+class AllocConstraint
+{
+public:
+  AllocConstraint (size_t max_count, size_t max_bytes, const char* file, int line);
+  ~AllocConstraint ();
+
+private:
+  void operator=(AllocConstraint const&) = delete;
+  AllocConstraint (AllocConstraint const&) = delete;
+
+  AllocMeter meter;
+  const char* filename;
+  int line_number;
+  size_t max_count;
+  size_t max_bytes;
 };
 
 /// A singleton object containing all test suites
 class SuitesList {
 public:
-  void Add (const std::string& suite, const TestSuite::Inserter* inf);
-  int Run (const std::string& suite, Reporter& reporter, std::chrono::milliseconds max_time);
-  int RunAll (Reporter& reporter, std::chrono::milliseconds max_time);
+  void Add (const Symbol& suite, const TestSuite::Inserter* inf);
+  int Run (const std::string& suite, Reporter& reporter, std::chrono::nanoseconds max_time);
+  int RunAll (Reporter& reporter, std::chrono::nanoseconds max_time);
   static SuitesList& GetSuitesList ();
   void Enable (const std::string& suite, bool enable = true);
 
@@ -469,16 +702,69 @@ struct tolerance_not_set : public std::runtime_error
 extern Test* CurrentTest;
 
 /// Name of currently running suite
-extern std::string CurrentSuite;
+extern Symbol CurrentSuite;
 
 /// Pointer to current reporter object
 extern Reporter* CurrentReporter;
 
+/*!
+  Suite and test of the event being reported.
+
+  Reporters wrapped by an AsyncReporter receive events on a background
+  thread, after CurrentSuite and CurrentTest have moved on. While it delivers
+  an event, the background thread sets this context to the suite and test
+  that produced the event.
+*/
+struct ReportContext
+{
+  const Symbol* suite;      ///< Suite of event or `nullptr` if not set
+  const Test* test;         ///< %Test of event or `nullptr` if outside a test
+};
+
+/// Return report context of calling thread
+inline
+ReportContext& report_context ()
+{
+  static thread_local ReportContext ctx{ nullptr, nullptr };
+  return ctx;
+}
+
+/// Return suite of the event being reported. Reporters use this instead of CurrentSuite.
+inline
+const Symbol& reported_suite ()
+{
+  auto& ctx = report_context ();
+  return ctx.suite ? *ctx.suite : CurrentSuite;
+}
+
+/// Return test of the event being reported. Reporters use this instead of CurrentTest.
+inline
+const Test* reported_test ()
+{
+  auto& ctx = report_context ();
+  return ctx.suite ? ctx.test : CurrentTest;
+}
+
+/*!
+  Return list where the calling thread saves its failures, or `nullptr` if
+  failures are reported immediately.
+
+  Worker threads of multithreaded benchmarks save their failures here. The
+  test thread reports them after the workers have finished, so that reporters
+  and failure counts are used only by the test thread.
+*/
+inline
+std::vector<Failure>*& deferred_failures ()
+{
+  static thread_local std::vector<Failure>* list = nullptr;
+  return list;
+}
+
 /// Return the default reporter object
 Reporter& GetDefaultReporter ();
 
 /// Run all tests from all test suites
-int RunAllTests (Reporter& rpt = GetDefaultReporter (), std::chrono::milliseconds max_time = std::chrono::milliseconds{ 0 });
+int RunAllTests (Reporter& rpt = GetDefaultReporter (), std::chrono::nanoseconds max_time = std::chrono::nanoseconds{ 0 });
 
 /// Disable a test suite
 void DisableSuite (const std::string& suite_name);
@@ -487,35 +773,78 @@ void DisableSuite (const std::string& suite_name);
 void EnableSuite (const std::string& suite_name);
 
 /// Run all tests from one suite
-int RunSuite (const char *suite_name, Reporter& rpt = GetDefaultReporter (), std::chrono::milliseconds max_time = std::chrono::milliseconds{ 0 });
+int RunSuite (const char *suite_name, Reporter& rpt = GetDefaultReporter (), std::chrono::nanoseconds max_time = std::chrono::nanoseconds{ 0 });
 
 /// Main error reporting function
-void ReportFailure (const std::string& filename, int line, const std::string& message);
+void ReportFailure (const Symbol& filename, int line, const std::string& message);
+
+/*!
+  Return a duration as a string using the most suitable unit.
+
+  Durations are shown in seconds, milliseconds, microseconds or nanoseconds
+  so that the integer part is not 0.
+*/
+inline
+std::string duration_string (std::chrono::nanoseconds d)
+{
+  std::ostringstream os;
+  auto ns = d.count ();
+  auto abs_ns = ns < 0 ? -ns : ns;
+  if (abs_ns >= 1000000000)
+    os << ns / 1e9 << "s";
+  else if (abs_ns >= 1000000)
+    os << ns / 1e6 << "ms";
+  else if (abs_ns >= 1000)
+    os << ns / 1e3 << "us";
+  else
+    os << ns << "ns";
+  return os.str ();
+}
 
 //-------------------------- Test member functions ----------------------------
 /// Constructor
 inline
-Test::Test(const std::string& test_name)
+Test::Test(const Symbol& test_name)
     : name(test_name)
     , failures(0)
     , time(0)
     , time_exempt(false)
+    , allocs ()
+    , rusage ()
+    , perf ()
 {
 }
 
 /*!
   Starts a timer and calls RunImpl() to execute test code.
 
-  When RunImpl() returns, it records the elapsed time.
+  When RunImpl() returns, it records the elapsed time, the heap allocations,
+  the operating system resources used by the test and the performance
+  counters. These are recorded also if the test throws an exception.
 */
 inline
 void Test::run()
 {
-    Timer test_timer;
-    test_timer.Start();
+  ResourceMeter resources;
+  PerfMeter counters;
+  AllocMeter meter;
+  Timer test_timer;
+  test_timer.Start();
 
+  try {
     RunImpl();
-    time = test_timer.GetTimeInMs();
+  }
+  catch (...) {
+    time = test_timer.GetTimeInNs ();
+    allocs = meter.stats ();
+    perf = counters.counters ();
+    rusage = resources.usage ();
+    throw;
+  }
+  time = test_timer.GetTimeInNs ();
+  allocs = meter.stats ();
+  perf = counters.counters ();
+  rusage = resources.usage ();
 }
 
 /*!
@@ -534,20 +863,60 @@ int Test::failure_count () const
   return failures;
 }
 
-/// Return test running time in milliseconds
+/// Return test running time
 inline
-std::chrono::milliseconds Test::test_time_ms () const
+std::chrono::nanoseconds Test::test_time () const
 {
   return time;
 }
 
+/// Return test running time truncated to milliseconds
+inline
+std::chrono::milliseconds Test::test_time_ms () const
+{
+  return std::chrono::duration_cast<std::chrono::milliseconds>(time);
+}
+
 /// Return test name
 inline
 const std::string& Test::test_name () const
+{
+  return name.str ();
+}
+
+/// Return test name as an interned string
+inline
+const Symbol& Test::test_symbol () const
 {
   return name;
 }
 
+/*!
+  Return heap allocations made by the test.
+
+  Allocations are counted only if the program has been compiled with
+  allocation tracking enabled (see alloc.h).
+*/
+inline
+const AllocStats& Test::alloc_stats () const
+{
+  return allocs;
+}
+
+/// Return operating system resources used by test
+inline
+const ResourceUsage& Test::resource_usage () const
+{
+  return rusage;
+}
+
+/// Return performance counters of test (see perf.h)
+inline
+const PerfCounters& Test::perf_counters () const
+{
+  return perf;
+}
+
 /// Flags the test as exempt from global time constraint
 inline
 void Test::no_time_constraint ()
@@ -584,6 +953,7 @@ void Reporter::SuiteStart (const TestSuite&)
 {
   suites_count++;
   suite_test_count = suite_failed_count = suite_failures_count = 0;
+  suite_time = std::chrono::nanoseconds (0);
 }
 
 inline
@@ -598,6 +968,16 @@ void Reporter::ReportFailure (const Failure&)
 {
 }
 
+inline
+void Reporter::ReportBenchmark (const BenchmarkStats&)
+{
+}
+
+inline
+void Reporter::ReportComplexity (const ComplexityFit&)
+{
+}
+
 inline
 void Reporter::TestFinish (const Test& t)
 {
@@ -609,9 +989,9 @@ void Reporter::TestFinish (const Test& t)
     total_failed_count++;
     total_failures_count += f;
   }
-  auto ms = t.test_time_ms ();
-  suite_time += ms;
-  total_time += ms;
+  auto ns = t.test_time ();
+  suite_time += ns;
+  total_time += ns;
 }
 
 ///  \return number of failures in this suite
@@ -629,12 +1009,12 @@ void Reporter::Clear ()
   suite_test_count =
     suite_failed_count =
     suite_failures_count = 0;
-    suite_time = 0ms;
+    suite_time = 0ns;
 
     total_test_count =
       total_failed_count =
       total_failures_count = 0;
-    total_time = 0ms;
+    total_time = 0ns;
 
   suites_count = 0;
 }
@@ -644,15 +1024,23 @@ void Reporter::Clear ()
 inline
 ReporterDeferred::TestResult::TestResult ()
   : test_time{0}
+  , allocs ()
+  , rusage ()
+  , perf ()
+  , complexity ()
 {
 }
 
 /// Constructor
 inline
-ReporterDeferred::TestResult::TestResult (const std::string& suite, const std::string& test)
+ReporterDeferred::TestResult::TestResult (const Symbol& suite, const Symbol& test)
   : suite_name (suite)
   , test_name (test)
   , test_time (0)
+  , allocs ()
+  , rusage ()
+  , perf ()
+  , complexity ()
 {
 }
 
@@ -666,7 +1054,8 @@ ReporterDeferred::TestResult::TestResult (const std::string& suite, const std::s
 inline
 void ReporterDeferred::SuiteStart (const TestSuite& suite)
 {
-  results.push_back (TestResult (suite.name, std::string()));
+  Reporter::SuiteStart (suite);
+  results.push_back (TestResult (suite.name, Symbol ()));
 }
 
 /*!
@@ -679,7 +1068,7 @@ inline
 void ReporterDeferred::TestStart (const Test& test)
 {
   Reporter::TestStart (test);
-  results.push_back (TestResult (CurrentSuite, test.test_name ()));
+  results.push_back (TestResult (reported_suite (), test.test_symbol ()));
 }
 
 /*!
@@ -695,6 +1084,34 @@ void ReporterDeferred::ReportFailure (const Failure& failure)
   results.back ().failures.push_back (failure);
 }
 
+/*!
+  Called when a benchmark has finished.
+  \param stats  Benchmark results
+
+  Results are added to current test results.
+*/
+inline
+void ReporterDeferred::ReportBenchmark (const BenchmarkStats& stats)
+{
+  assert (!results.empty ());
+
+  Reporter::ReportBenchmark (stats);
+  results.back ().benchmarks.push_back (stats);
+}
+
+/*!
+  Called when the results of a parameterized benchmark have been fitted.
+  \param fit  Complexity class and fit error
+*/
+inline
+void ReporterDeferred::ReportComplexity (const ComplexityFit& fit)
+{
+  assert (!results.empty ());
+
+  Reporter::ReportComplexity (fit);
+  results.back ().complexity = fit;
+}
+
 /*!
   Store test runtime when the test finishes
   \param  test    %Test that is about to end
@@ -703,7 +1120,10 @@ inline
 void ReporterDeferred::TestFinish (const Test& test)
 {
   Reporter::TestFinish (test);
-  results.back ().test_time = test.test_time_ms();
+  results.back ().test_time = test.test_time ();
+  results.back ().allocs = test.alloc_stats ();
+  results.back ().rusage = test.resource_usage ();
+  results.back ().perf = test.perf_counters ();
 }
 
 inline void ReporterDeferred::Clear ()
@@ -716,7 +1136,7 @@ inline void ReporterDeferred::Clear ()
 //------------------- TestSuite member functions ------------------------------
 
 inline
-TestSuite::TestSuite (const std::string& name_)
+TestSuite::TestSuite (const Symbol& name_)
   : name (name_)
   , max_runtime (0)
   , enabled (true)
@@ -747,7 +1167,7 @@ void TestSuite::Add (const Inserter* inf)
   Iterate through all test information objects doing the following:
 */
 inline
-int TestSuite::RunTests (Reporter& rep, std::chrono::milliseconds maxtime)
+int TestSuite::RunTests (Reporter& rep, std::chrono::nanoseconds maxtime)
 {
   /// Establish reporter as CurrentReporter and suite as CurrentSuite
   CurrentSuite = name;
@@ -849,23 +1269,22 @@ void TestSuite::RunCurrentTest (const Inserter* inf)
     ReportFailure (inf->file_name, inf->line, stream.str ());
   }
 
-  auto actual_time = CurrentTest->test_time_ms ();
+  auto actual_time = CurrentTest->test_time ();
   if (CurrentTest->is_time_constraint () && max_runtime.count() && actual_time > max_runtime)
   {
     std::stringstream stream;
     stream << "Global time constraint failed while running test " << inf->test_name
-      << " Expected time <"
-#if UTPP_STD_CHRONO_OSTREAM_AVAILABLE
-      << max_runtime
-#else
-      << max_runtime.count () << "ms"
-#endif
-      << "; actual = "
-#if UTPP_STD_CHRONO_OSTREAM_AVAILABLE
-      << actual_time;
-#else
-      << actual_time.count ();
-#endif
+      << " Expected time <" << duration_string (max_runtime)
+      << "; actual = " << duration_string (actual_time);
+    ReportFailure (inf->file_name, inf->line, stream.str ());
+  }
+
+  auto leaked = CurrentTest->alloc_stats ().leaked;
+  if (fail_on_leaks && alloc_tracking_installed () && leaked > 0)
+  {
+    std::stringstream stream;
+    stream << "Memory leak while running test " << inf->test_name
+      << ": " << leaked << " bytes not released";
     ReportFailure (inf->file_name, inf->line, stream.str ());
   }
   CurrentReporter->TestFinish (*CurrentTest);
@@ -920,8 +1339,8 @@ void TestSuite::Enable (bool on_off)
   Calls SuiteList::Add() to add the test to a suite.
 */
 inline
-TestSuite::Inserter::Inserter (const std::string& suite, const std::string& test,
-    const std::string& file, int ln, Testmaker func)
+TestSuite::Inserter::Inserter (const Symbol& suite, const Symbol& test,
+    const Symbol& file, int ln, Testmaker func)
   : test_name (test)
   , file_name (file)
   , line (ln)
@@ -933,6 +1352,7 @@ TestSuite::Inserter::Inserter (const std::string& suite, const std::string& test
 //-----------------Timer member functions -------------------------------------
 inline
 Timer::Timer ()
+  : startTime (0)
 {
 }
 
@@ -940,23 +1360,28 @@ Timer::Timer ()
 inline
 void Timer::Start ()
 {
-  startTime = std::chrono::steady_clock::now ();
+  startTime = TimeSource::instance ().now ();
 }
 
 /// Return elapsed time in milliseconds since the starting time
 inline
 std::chrono::milliseconds Timer::GetTimeInMs () const
 {
-  auto elapsedTime = std::chrono::steady_clock::now () - startTime;
-  return std::chrono::duration_cast<std::chrono::milliseconds>(elapsedTime);
+  return std::chrono::duration_cast<std::chrono::milliseconds>(GetTimeInNs ());
 }
 
 /// Return elapsed time in microseconds since the starting time
 inline
 std::chrono::microseconds Timer::GetTimeInUs () const
 {
-  auto elapsedTime = std::chrono::steady_clock::now () - startTime;
-  return std::chrono::duration_cast<std::chrono::microseconds>(elapsedTime);
+  return std::chrono::duration_cast<std::chrono::microseconds>(GetTimeInNs ());
+}
+
+/// Return elapsed time in nanoseconds since the starting time
+inline
+std::chrono::nanoseconds Timer::GetTimeInNs () const
+{
+  return std::chrono::nanoseconds (TimeSource::instance ().now () - startTime);
 }
 
 //------------------TimeConstraint member functions ---------------------------
@@ -974,7 +1399,7 @@ template <typename R, typename P>
 TimeConstraint::TimeConstraint (std::chrono::duration<R, P> t, const char* file, int line)
   : filename (file)
   , line_number (line)
-  , tmax (t)
+  , tmax (std::chrono::duration_cast<std::chrono::nanoseconds>(t))
 {
   timer.Start ();
 }
@@ -986,26 +1411,65 @@ TimeConstraint::TimeConstraint (std::chrono::duration<R, P> t, const char* file,
 inline
 TimeConstraint::~TimeConstraint ()
 {
-  std::chrono::milliseconds t = timer.GetTimeInMs ();
+  std::chrono::nanoseconds t = timer.GetTimeInNs ();
   if (t > tmax)
   {
     std::stringstream stream;
-    stream << "Time constraint failed. Expected time <"
-#if UTPP_STD_CHRONO_OSTREAM_AVAILABLE
-      << tmax
-#else
-      << tmax.count () << "ms"
-#endif
-      << "; actual = "
-#if UTPP_STD_CHRONO_OSTREAM_AVAILABLE
-      << t;
-#else
-      << t.count () << "ms";
-#endif
+    stream << "Time constraint failed. Expected time <" << duration_string (tmax)
+      << "; actual = " << duration_string (t);
     ReportFailure (filename, line_number, stream.str ());
   }
 }
 
+//------------------AllocConstraint member functions --------------------------
+
+/*!
+  Initializes an AllocConstraint object.
+  \param max_count  Maximum allowed number of allocations
+  \param max_bytes  Maximum allowed number of bytes allocated
+  \param file       Filename associated with this constraint
+  \param line       Line number associated with this constraint
+
+  Allocations are counted from now until the object goes out of scope.
+*/
+inline
+AllocConstraint::AllocConstraint (size_t max_count_, size_t max_bytes_,
+                                  const char* file, int line)
+  : filename (file)
+  , line_number (line)
+  , max_count (max_count_)
+  , max_bytes (max_bytes_)
+{
+}
+
+/*!
+  If the scope made more allocations, or allocated more bytes, than allowed
+  it records an allocation constraint failure for the current test.
+
+  If allocations are not tracked, the constraint cannot be verified and it
+  is reported as failed.
+*/
+inline
+AllocConstraint::~AllocConstraint ()
+{
+  if (!alloc_tracking_installed ())
+  {
+    ReportFailure (filename, line_number,
+      "Allocation constraint cannot be checked. "
+      "Define UTPP_TRACK_ALLOCATIONS to enable allocation tracking");
+    return;
+  }
+  AllocStats s = meter.stats ();
+  if (s.count > max_count || s.bytes > max_bytes)
+  {
+    AllocPause pause;
+    std::stringstream stream;
+    stream << "Allocation constraint failed. Expected at most "
+      << max_count << " allocations and " << max_bytes << " bytes"
+      << "; actual = " << s.count << " allocations and " << s.bytes << " bytes";
+    ReportFailure (filename, line_number, stream.str ());
+  }
+}
 
 //-------------------SuitesList member functions ------------------------------
 
@@ -1018,7 +1482,7 @@ TimeConstraint::~TimeConstraint ()
   If a suite with that name does not exist, it is created now.
 */
 inline
-void SuitesList::Add (const std::string& suite_name, const TestSuite::Inserter* inf)
+void SuitesList::Add (const Symbol& suite_name, const TestSuite::Inserter* inf)
 {
   auto p = suites.begin ();
   while (p != suites.end () && p->name != suite_name)
@@ -1038,12 +1502,12 @@ void SuitesList::Add (const std::string& suite_name, const TestSuite::Inserter*
 
   \param suite_name name of the suite to run
   \param reporter test reporter to be used for results
-  \param max_time global time constraint in milliseconds
+  \param max_time global time constraint
 
   \return number of tests that failed or -1 if there is no such suite
 */
 inline
-int SuitesList::Run (const std::string& suite_name, Reporter& reporter, std::chrono::milliseconds max_time)
+int SuitesList::Run (const std::string& suite_name, Reporter& reporter, std::chrono::nanoseconds max_time)
 {
   for (auto& s : suites)
   {
@@ -1059,12 +1523,12 @@ int SuitesList::Run (const std::string& suite_name, Reporter& reporter, std::chr
 /*!
   Run tests in all suites
   \param reporter test reporter to be used for results
-  \param max_time global time constraint in milliseconds
+  \param max_time global time constraint
 
   \return total number of failed tests
 */
 inline
-int SuitesList::RunAll (Reporter& reporter, std::chrono::milliseconds max_time)
+int SuitesList::RunAll (Reporter& reporter, std::chrono::nanoseconds max_time)
 {
   for (auto& s : suites)
   {
@@ -1114,7 +1578,7 @@ void SuitesList::Enable (const std::string& suite, bool enable)
   \param  max_time      Global time constraint or 0 if there is no time constraint.
   \return number of failed tests
 
-  Each test is expected to run in under `max_time` milliseconds. If a test takes
+  Each test is expected to run in under `max_time`. If a test takes
   longer, it generates a time constraint failure.
 
   All previous statistics of the reporter object are erased.
@@ -1122,7 +1586,7 @@ void SuitesList::Enable (const std::string& suite, bool enable)
   \ingroup exec
 */
 inline
-int RunAllTests (Reporter& rpt, std::chrono::milliseconds max_time)
+int RunAllTests (Reporter& rpt, std::chrono::nanoseconds max_time)
 {
   rpt.Clear ();
   return SuitesList::GetSuitesList ().RunAll (rpt, max_time);
@@ -1133,14 +1597,14 @@ int RunAllTests (Reporter& rpt, std::chrono::milliseconds max_time)
 
   \param suite_name   Name of the suite to run
   \param rpt          Test reporter to be used for results
-  \param max_time     Global time constraint in milliseconds
+  \param max_time     Global time constraint
 
   \return number of tests that failed or -1 if there is no such suite
 
   \ingroup exec
 */
 inline
-int RunSuite (const char* suite_name, Reporter& rpt, std::chrono::milliseconds max_time)
+int RunSuite (const char* suite_name, Reporter& rpt, std::chrono::nanoseconds max_time)
 {
   return SuitesList::GetSuitesList ().Run (suite_name, rpt, max_time);
 }
@@ -1179,14 +1643,24 @@ void EnableSuite (const std::string& suite_name)
   \param message  Failure description
 
   It calls the TestReporter::ReportFailure function of the current reporter
-  object.
+  object. Allocations made by the reporter are not counted as allocations of
+  the current test.
+
+  If the calling thread has a list of deferred failures, the failure is only
+  added to that list.
 */
 inline
-void ReportFailure(const std::string& filename, int line, const std::string& message)
+void ReportFailure(const Symbol& filename, int line, const std::string& message)
 {
+    AllocPause pause;
+    Failure f = { filename, message, line };
+    if (auto saved = deferred_failures ())
+    {
+        saved->push_back (std::move (f));
+        return;
+    }
     if (CurrentTest)
         CurrentTest->failure();
-    Failure f = { filename, message, line };
     CurrentReporter->ReportFailure(f);
 }
 
@@ -1203,8 +1677,19 @@ const char* GetSuiteName ()
   return DEFAULT_SUITE;
 }
 
+#include "baseline.h"
+#include "environment.h"
+#include "histogram.h"
+#include "benchmark.h"
+#include "block_buffer.h"
 #include "reporter_stream.h"
+#include "escape.h"
 #include "reporter_xml.h"
+#include "reporter_xml_streaming.h"
+#include "reporter_junit.h"
+#include "reporter_json.h"
+#include "reporter_multi.h"
+#include "reporter_async.h"
 #ifdef _WIN32
 #include "reporter_dbgout.h"
 #endif
@@ -1222,7 +1707,7 @@ UnitTest::Reporter& UnitTest::GetDefaultReporter ()
 // In C++ 17 and later we have inline data. TEST_MAIN is not really needed.
 inline UnitTest::Test* UnitTest::CurrentTest;
 inline UnitTest::Reporter* UnitTest::CurrentReporter;
-inline std::string UnitTest::CurrentSuite;
+inline UnitTest::Symbol UnitTest::CurrentSuite;
 #endif
 
 #ifdef _MSC_VER
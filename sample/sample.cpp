@@ -7,16 +7,22 @@
   Sample test program for UTPP library
 */
 
+// Count heap allocations made by each test. Define this in only one source file.
+#define UTPP_TRACK_ALLOCATIONS
 #include <utpp/utpp.h>
 
 /*-------------------------- Functions under test ---------------------------*/
 #include <vector>
+#include <algorithm>
 #include <array>
 #include <iostream>
 #include <iomanip>
 #include <fstream>
 #include <exception>
 #include <thread>
+#include <atomic>
+#include <numeric>
+#include <sstream>
 
 bool earth_is_round () {
   return true;
@@ -117,6 +123,8 @@ SUITE (EarthSuite)
     CHECK_CLOSE (6371., earth_radius_km ());
     CHECK_EQUAL_EX (6371.0, earth_radius_km (), "difference=%lf", fabs(6371.0-earth_radius_km ()) );
     CHECK_CLOSE_EX (6371., earth_radius_km (), 0.5, "This is an expected failure");
+    //std::format style message
+    CHECK_EQUAL_FMT (6371.0, earth_radius_km (), "difference={}", fabs(6371.0-earth_radius_km ()));
   }
 
   // Example of CHECK_EQUAL macro
@@ -141,6 +149,13 @@ SUITE (EarthSuite)
     CHECK_THROW (go_to_end_of_earth (), flat_earth_exception);
     CHECK_THROW_EX (planet_name (), flat_earth_exception, "just testing CHECK_THROW_EX macro");
   }
+
+  // Example of a benchmark placed in the same suite as the tests
+  BENCHMARK (EarthRadiusSpeed)
+  {
+    for (auto _ : state)
+      UnitTest::DoNotOptimize (earth_radius_km ());
+  }
 }
 
 // Example of CHECK_NAN
@@ -300,6 +315,69 @@ TEST_FIXTURE (Account_fixture, TestExchangeChf)
   CHECK (amount_chf > 0);
 }
 
+// Benchmark with a fixture
+BENCHMARK_FIXTURE (Account_fixture, ExchangeSpeed)
+{
+  for (auto _ : state)
+  {
+    amount_usd = 100;
+    exchange_to_eur (amount_usd, amount_eur);
+    UnitTest::ClobberMemory ();
+  }
+}
+
+// Benchmark that runs for a range of sizes and checks that the time grows
+// no faster than log(N)
+BENCHMARK_ARGS (SortedSearch, Range (8, 8192).Complexity (UnitTest::oLogN))
+{
+  std::vector<int> v (state.range ());
+  for (size_t i = 0; i < v.size (); ++i)
+    v[i] = (int)(2 * i);
+
+  int key = 0;
+  for (auto _ : state)
+  {
+    UnitTest::DoNotOptimize (std::lower_bound (v.begin (), v.end (), key));
+    key = (key + 7) % (2 * (int)v.size ());
+  }
+}
+
+// Benchmark that measures the latency distribution of an operation and
+// checks its tail
+BENCHMARK_ARGS (SortLatency, Latency ())
+{
+  std::vector<int> v (64);
+  for (auto _ : state)
+  {
+    for (size_t i = 0; i < v.size (); ++i)
+      v[i] = (int)((i * 37) % v.size ());
+    std::sort (v.begin (), v.end ());
+    UnitTest::DoNotOptimize (v);
+  }
+  CHECK_LATENCY_P99 (std::chrono::milliseconds (10));
+}
+
+// Benchmark that reports its throughput in bytes per second
+BENCHMARK (CopySpeed)
+{
+  std::vector<char> src (4096, 'a'), dst (4096);
+  for (auto _ : state)
+  {
+    std::copy (src.begin (), src.end (), dst.begin ());
+    UnitTest::DoNotOptimize (dst);
+  }
+  state.SetBytesProcessed ((long long)(state.iterations () * src.size ()));
+}
+
+// Benchmark that runs on 1, 2 and 4 threads to show how a shared counter
+// scales
+BENCHMARK_ARGS (SharedCounter, Threads ({1, 2, 4}))
+{
+  static std::atomic<long> counter;
+  for (auto _ : state)
+    counter.fetch_add (1, std::memory_order_relaxed);
+}
+
 TEST_FIXTURE (Account_fixture, Uncaught_exception)
 {
   throw_2 ();
@@ -457,6 +535,39 @@ SUITE (not_run)
   }
 }
 
+/* Suite used to show the output of other reporters. It is disabled and
+   main() runs it with each reporter. */
+SUITE (reporters)
+{
+  TEST (Passes)
+  {
+    CHECK_EQUAL (4, 2 + 2);
+  }
+
+  TEST (Fails)
+  {
+    CHECK_EQUAL (5, 2 + 2);
+  }
+
+  /* Failures reported while a fixture is destroyed belong to the test that
+     used the fixture */
+  struct Teardown_fixture {
+    ~Teardown_fixture () { CHECK_EQUAL (1, 2); }
+  };
+
+  TEST_FIXTURE (Teardown_fixture, FailsInTeardown)
+  {
+    CHECK (true);
+  }
+
+  BENCHMARK (Accumulate)
+  {
+    std::vector<int> v (256, 1);
+    for (auto _ : state)
+      UnitTest::DoNotOptimize (std::accumulate (v.begin (), v.end (), 0));
+  }
+}
+
 SUITE (time_limits)
 {
   using namespace std::chrono_literals;
@@ -489,6 +600,30 @@ SUITE (time_limits)
   }
 }
 
+SUITE (allocations)
+{
+  // Checks that a computation does not use the heap
+  TEST (NoAllocations)
+  {
+    UTPP_NO_ALLOC ();
+    std::array<int, 10> a{};
+    for (size_t i = 0; i < a.size (); i++)
+      a[i] = (int)(i * i);
+    CHECK_EQUAL (81, a[9]);
+  }
+
+  // Limits the allocations made by a vector
+  TEST (AllocationBudget)
+  {
+    UTPP_ALLOC_CONSTRAINT (1, 100 * sizeof (int));
+    std::vector<int> v;
+    v.reserve (100);
+    for (int i = 0; i < 100; i++)
+      v.push_back (i);
+    CHECK_EQUAL (99, v.back ());
+  }
+}
+
 SUITE (utf16_checks)
 {
   TEST (conversion)
@@ -578,6 +713,19 @@ SUITE (typecasting)
   }
 }
 
+/* Stream buffer that collects output but cannot be repositioned, like
+   a pipe */
+struct pipe_buf : public std::streambuf {
+  std::string text;
+
+protected:
+  int_type overflow (int_type c) override {
+    if (!traits_type::eq_int_type (c, traits_type::eof ()))
+      text += traits_type::to_char_type (c);
+    return traits_type::not_eof (c);
+  }
+};
+
 TEST_MAIN (int argc, char** argv)
 {
   using namespace std::chrono_literals;
@@ -589,8 +737,19 @@ TEST_MAIN (int argc, char** argv)
   //Suites can be disabled using the "DisableSuite" function
   UnitTest::DisableSuite ("not_run");
   UnitTest::DisableSuite ("time_limits"); //
+  UnitTest::DisableSuite ("reporters");
   UnitTest::default_tolerance = .001;
 
+  //Keep benchmarks short
+  UnitTest::benchmark_min_time = 10ms;
+  UnitTest::benchmark_warmup = 5ms;
+
+  //Measure page faults, context switches and I/O of each test
+  UnitTest::track_resources = true;
+
+  //Read hardware performance counters (Linux only)
+  UnitTest::track_perf_counters = true;
+
   ret = UnitTest::RunAllTests ();
   std::cout << "RunAllTests() returned " << ret << std::endl;
 
@@ -617,12 +776,68 @@ TEST_MAIN (int argc, char** argv)
   ret1 = UnitTest::RunAllTests (xml, 3s);
   std::cout << "RunAllTests() returned " << ret1 << std::endl;
 
-  //A second run of all tests just to see that results are consistent
-  auto ret2 = UnitTest::RunAllTests (xml, 3s);
+  //A second run of all tests just to see that results are consistent.
+  //This time results go both to the XML file and to the console.
+  UnitTest::ReporterStream console;
+  UnitTest::MultiReporter both {&xml, &console};
+  auto ret2 = UnitTest::RunAllTests (both, 3s);
   std::cout << "2nd run of RunAllTests() returned "
     << ret2 << std::endl;
 
+  //The streaming XML reporter writes each test as soon as it is complete.
+  //If the stream is seekable, totals are filled in the root element...
+  std::ostringstream xml_text;
+  UnitTest::ReporterXmlStreaming xml_streaming (xml_text);
+  UnitTest::RunSuite ("reporters", xml_streaming);
+
+  //...otherwise they are written in a <totals> element at the end.
+  pipe_buf pipe;
+  std::ostream pipe_stream (&pipe);
+  UnitTest::ReporterXmlStreaming xml_pipe (pipe_stream);
+  UnitTest::RunSuite ("reporters", xml_pipe);
+  std::cout << "Streaming XML report written to a pipe:\n" << pipe.text;
+
+  //JUnit XML format is understood by most CI servers
+  std::cout << "Running again with results sent to JUNIT.XML file..."
+    << std::endl;
+  std::ofstream junit_os ("junit.xml");
+  UnitTest::ReporterJUnit junit (junit_os);
+  UnitTest::RunSuite ("reporters", junit);
+
+  //JSON reporter writes one line for each event, as it happens
+  std::cout << "Running again with results sent to console in JSON format..."
+    << std::endl;
+  UnitTest::ReporterJson json (std::cout);
+  UnitTest::RunSuite ("reporters", json);
+
+  //AsyncReporter hands the work of another reporter to a background thread
+  std::cout << "Running again with console output from a background thread..."
+    << std::endl;
+  UnitTest::ReporterStream async_console;
+  UnitTest::AsyncReporter async (async_console);
+  UnitTest::RunSuite ("reporters", async);
+
+  //Benchmark results can be saved in a baseline file and compared with the
+  //results of a later run. A benchmark is reported as slower or faster only
+  //if the difference is statistically significant.
+  std::cout << "Saving benchmark results to BASELINE.TXT file..." << std::endl;
+  UnitTest::ReporterStream save_console;
+  UnitTest::benchmark_baseline.Clear ();
+  UnitTest::RunSuite ("reporters", save_console);
+  bool baseline_saved = UnitTest::benchmark_baseline.Save ("baseline.txt");
+
+  std::cout << "Comparing benchmark results with baseline..." << std::endl;
+  //Timing noise should not make the sample fail
+  UnitTest::benchmark_baseline.fail_on_regression = false;
+  bool baseline_loaded = UnitTest::benchmark_baseline.Load ("baseline.txt");
+  UnitTest::ReporterStream compare_console;
+  UnitTest::RunSuite ("reporters", compare_console);
+
   UnitTest::CurrentReporter = &UnitTest::GetDefaultReporter ();
+  //Totals of the seekable stream are in the root element
+  CHECK (xml_text.str ().find ("<totals") == std::string::npos);
+  CHECK (baseline_saved && baseline_loaded);
+
   // CHECK macros can also be used outside of tests. Example:
   CHECK_EQUAL (0, ret); // should fail
 